@@ -2,6 +2,7 @@
 #include "../util/string.hpp"
 
 #include "../interface/console.hpp"
+#include "../interface/resources.hpp"
 
 namespace maf {
 	void print(const StyledText & text, ostream & out) {
@@ -40,6 +41,12 @@ int main() {
 
 	std::ios_base::sync_with_stdio(false);
 
+	try {
+		resources::open_pack();
+	} catch (const resources::Bad_pack & error) {
+		std::cerr << error.message() << "\n";
+	}
+
 	Console console{};
 	print_output(console);
 
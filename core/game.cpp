@@ -11,13 +11,21 @@ namespace maf::core {
 
 	Game::Game(span<const Role::ID> role_ids,
 		span<const Wildcard::ID> wildcard_ids,
-		const Rulebook & rulebook)
-	: _rulebook{rulebook} {
+		const Rulebook & rulebook,
+		optional<Random_streams::Seed> seed)
+	:
+		_rulebook{rulebook},
+		_role_ids(role_ids.begin(), role_ids.end()),
+		_wildcard_ids(wildcard_ids.begin(), wildcard_ids.end()),
+		_random{seed ? Random_streams{*seed} : Random_streams{}}
+	{
+		using Purpose = Random_streams::Purpose;
+
 		auto append_to_random_roles = std::back_inserter(_random_roles);
 
 		util::transform(wildcard_ids, append_to_random_roles, [&](Wildcard::ID id) -> const Role & {
 			Wildcard & wildcard = _rulebook.get_wildcard(id);
-			const Role & role = wildcard.pick_role(_rulebook);
+			const Role & role = wildcard.pick_role(_rulebook, _random(Purpose::wildcard));
 			return role;
 		});
 
@@ -29,7 +37,7 @@ namespace maf::core {
 			return role;
 		});
 		util::copy(_random_roles, append_to_cards);
-		util::shuffle(cards);
+		util::shuffle(cards, _random(Purpose::deal));
 
 		for (index i = 0; i < cards.size(); ++i) {
 			const Role & role = cards[i];
@@ -78,6 +86,8 @@ namespace maf::core {
 	}
 
 	void Game::kick_player(Player::ID id) {
+		++_version;
+
 		using Reason = Kick_failed::Reason;
 
 		Player& player = find_player(id);
@@ -122,6 +132,8 @@ namespace maf::core {
 	}
 
 	void Game::cast_lynch_vote(Player::ID voter_id, Player::ID target_id) {
+		++_version;
+
 		using Reason = Lynch_vote_failed::Reason;
 
 		Player& voter = find_player(voter_id);
@@ -142,6 +154,8 @@ namespace maf::core {
 	}
 
 	void Game::clear_lynch_vote(Player::ID voter_id) {
+		++_version;
+
 		using Reason = Lynch_vote_failed::Reason;
 
 		Player& voter = find_player(voter_id);
@@ -157,6 +171,8 @@ namespace maf::core {
 	}
 
 	const Player * Game::process_lynch_votes() {
+		++_version;
+
 		using Reason = Lynch_failed::Reason;
 
 		if (ended())
@@ -166,7 +182,7 @@ namespace maf::core {
 
 		auto victim = const_cast<Player*>(next_lynch_victim());
 		if (victim) {
-			victim->kill(_date, _time);
+			victim->lynch(_date);
 			if (victim->is_troll()) _pending_haunters.push_back(victim);
 		}
 
@@ -178,6 +194,8 @@ namespace maf::core {
 	}
 
 	void Game::stage_duel(Player::ID caster_id, Player::ID target_id) {
+		++_version;
+
 		using Reason = Duel_failed::Reason;
 
 		Player& caster = find_player(caster_id);
@@ -200,8 +218,10 @@ namespace maf::core {
 		if (sum <= 0.0)
 			throw Duel_failed(caster, target, Reason::bad_probability);
 
+		auto& generator = _random(Random_streams::Purpose::duel);
+
 		auto p      = caster.duel_strength() / sum;
-		auto result = util::random::bernoulli_trial(p);
+		auto result = util::random::bernoulli_trial(p, generator);
 		auto winner = &(result ? caster : target);
 		auto loser  = &(result ? target : caster);
 
@@ -215,6 +235,8 @@ namespace maf::core {
 	}
 
 	void Game::begin_night() {
+		++_version;
+
 		using Reason = Begin_night_failed::Reason;
 
 		if (ended())
@@ -252,6 +274,8 @@ namespace maf::core {
 	}
 
 	void Game::choose_fake_role(Player::ID player_id, Role::ID fake_role_id) {
+		++_version;
+
 		using Reason = Choose_fake_role_failed::Reason;
 
 		Player& player = find_player(player_id);
@@ -272,6 +296,8 @@ namespace maf::core {
 	}
 
 	void Game::cast_mafia_kill(Player::ID caster_id, Player::ID target_id) {
+		++_version;
+
 		using Reason = Mafia_kill_failed::Reason;
 
 		Player& caster = find_player(caster_id);
@@ -300,6 +326,8 @@ namespace maf::core {
 	}
 
 	void Game::skip_mafia_kill() {
+		++_version;
+
 		if (ended())
 			throw Skip_failed{};
 		if (!is_night())
@@ -313,6 +341,8 @@ namespace maf::core {
 	}
 
 	void Game::cast_kill(Player::ID caster_id, Player::ID target_id) {
+		++_version;
+
 		using Reason = Kill_failed::Reason;
 
 		auto is_kill = [](const Ability& abl) {
@@ -338,6 +368,8 @@ namespace maf::core {
 	}
 
 	void Game::skip_kill(Player::ID caster_id) {
+		++_version;
+
 		auto is_kill = [](const Ability & abl) {
 			return abl.id == Ability::ID::kill;
 		};
@@ -355,6 +387,8 @@ namespace maf::core {
 	}
 
 	void Game::cast_heal(Player::ID caster_id, Player::ID target_id) {
+		++_version;
+
 		using Reason = Heal_failed::Reason;
 
 		auto is_heal = [](const Ability & abl) {
@@ -380,6 +414,8 @@ namespace maf::core {
 	}
 
 	void Game::skip_heal(Player::ID caster_id) {
+		++_version;
+
 		auto is_heal = [](const Ability & abl) {
 			return abl.id == Ability::ID::heal;
 		};
@@ -397,6 +433,8 @@ namespace maf::core {
 	}
 
 	void Game::cast_investigate(Player::ID caster_id, Player::ID target_id) {
+		++_version;
+
 		using Reason = Investigate_failed::Reason;
 
 		auto is_investigate = [](const Ability & abl) {
@@ -422,6 +460,8 @@ namespace maf::core {
 	}
 
 	void Game::skip_investigate(Player::ID caster_id) {
+		++_version;
+
 		auto is_investigate = [](const Ability & abl) {
 			return abl.id == Ability::ID::investigate;
 		};
@@ -439,6 +479,8 @@ namespace maf::core {
 	}
 
 	void Game::cast_peddle(Player::ID caster_id, Player::ID target_id) {
+		++_version;
+
 		using Reason = Peddle_failed::Reason;
 
 		auto is_peddle = [](const Ability & abl) {
@@ -462,6 +504,8 @@ namespace maf::core {
 	}
 
 	void Game::skip_peddle(Player::ID caster_id) {
+		++_version;
+
 		auto is_peddle = [](const Ability & abl) {
 			return abl.id == Ability::ID::peddle;
 		};
@@ -552,7 +596,8 @@ namespace maf::core {
 			}
 
 			if (!possible_victims.empty()) {
-				Player& victim = **util::random::pick(possible_victims);
+				auto& generator = _random(Random_streams::Purpose::haunt);
+				Player& victim = **util::random::pick(possible_victims, generator);
 				victim.kill(_date, _time);
 				victim.haunt(*haunter);
 			}
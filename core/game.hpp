@@ -1,11 +1,15 @@
 #ifndef MAFIA_CORE_GAME_H
 #define MAFIA_CORE_GAME_H
 
+#include <cstdint>
+
 #include "../util/misc.hpp"
+#include "../util/optional.hpp"
 #include "../util/span.hpp"
 #include "../util/vector.hpp"
 
 #include "player.hpp"
+#include "random.hpp"
 #include "role_ref.hpp"
 #include "rulebook.hpp"
 
@@ -228,13 +232,20 @@ namespace maf::core {
 		// Start a new game with the given parameters, creating a set of players
 		// and assigning each player an initial role.
 		// Note that this could lead to the game immediately ending.
+		//
+		// If `seed` is given, then every random choice made by the game is
+		// drawn from streams created from it. Otherwise a random seed is used.
 		Game(span<const Role::ID> role_ids,
 			span<const Wildcard::ID> wildcard_ids,
-			const Rulebook & rulebook = {});
+			const Rulebook & rulebook = {},
+			optional<Random_streams::Seed> seed = std::nullopt);
 
 		// The rulebook being used to run the game.
 		const Rulebook & rulebook() const { return _rulebook; }
 
+		// The seed that the game's random streams were created from.
+		Random_streams::Seed seed() const { return _random.seed(); }
+
 		// methods inherited from Rulebook
 		//
 		bool contains(RoleRef r_ref) const;
@@ -244,6 +255,11 @@ namespace maf::core {
 		// All of the roles obtained from wildcards in this game.
 		auto random_roles() const -> const vector_of_refs<const Role> &;
 
+		// The IDs of the rolecards that the game was set up with.
+		span<const Role::ID> role_ids() const { return _role_ids; }
+		// The IDs of the wildcards that the game was set up with.
+		span<const Wildcard::ID> wildcard_ids() const { return _wildcard_ids; }
+
 		// The participating players, both present and not present.
 		span<Player> players() { return _players; }
 		span<const Player> players() const { return _players; }
@@ -328,10 +344,19 @@ namespace maf::core {
 		// Whether or not the game has ended.
 		bool ended() const { return _ended; }
 
+		// A number which increases whenever the game might have changed,
+		// so that anything derived from the game can tell if it's stale.
+		std::uint64_t version() const { return _version; }
+
 	private:
+		std::uint64_t _version{0};
+
 		vector<Player> _players{};
 		Rulebook _rulebook;
+		vector<Role::ID> _role_ids;
+		vector<Wildcard::ID> _wildcard_ids;
 		vector_of_refs<const Role> _random_roles{};
+		Random_streams _random;
 
 		bool _ended{false};
 
@@ -0,0 +1,439 @@
+#include <cmath>
+#include <cstdint>
+#include <future>
+#include <map>
+#include <stdexcept>
+#include <thread>
+
+#include "../util/algorithm.hpp"
+#include "../util/misc.hpp"
+
+#include "inference.hpp"
+
+namespace maf::core::_infer_roles_impl {
+	// A set of roles, where bit `i` is set if the `i`th role in the rulebook
+	// is a member.
+	using role_mask = std::uint32_t;
+
+	// The largest number of roles that can be stored in a `role_mask`.
+	constexpr std::size_t max_roles = 32;
+
+	// The largest number of partial deals that can be summed over. Each
+	// state needs a few doubles in every evaluation, so this keeps the
+	// memory used in the hundreds of megabytes.
+	constexpr std::size_t max_states = std::size_t{1} << 22;
+
+	// The smallest number of states for which the deals are summed over in
+	// parallel. Below this, starting threads costs more than it saves.
+	constexpr std::size_t min_states_for_threads = 1 << 12;
+
+	// A group of identical cards in the deck, e.g. all copies of a
+	// particular wildcard.
+	struct card_group {
+		// The number of cards in the group.
+		int count;
+		// The probability of each card in the group ending up as each role,
+		// indexed in the same order as the rulebook.
+		vector<double> role_probs;
+		// The roles that a card in the group could end up as.
+		role_mask support;
+	};
+
+	// The partial deals of a deck, grouped by how many cards have been dealt
+	// from each card group. Player `i` is always dealt the `i`th card, so
+	// the number of cards dealt also determines the next player to be dealt
+	// a card.
+	//
+	// Each state is encoded in mixed radix, with the number of cards dealt
+	// from group `g` stored in the digit whose place value is `strides[g]`.
+	// This means that the state with no cards dealt is `0`, the state with
+	// every card dealt is `num_states - 1`, and dealing a card never
+	// decreases the state.
+	struct deal_space {
+		vector<card_group> groups;
+		vector<std::size_t> strides;
+		std::size_t num_states{1};
+		// The number of cards dealt in each state.
+		vector<int> num_dealt;
+
+		explicit deal_space(vector<card_group> card_groups)
+		: groups{move(card_groups)} {
+			for (auto& group: groups) {
+				auto radix = static_cast<std::size_t>(group.count + 1);
+
+				if (num_states > max_states / radix) {
+					string msg = "Roles can only be inferred for setups with at most ";
+					msg += std::to_string(max_states);
+					msg += " partial deals.";
+
+					throw std::length_error{msg};
+				}
+
+				strides.push_back(num_states);
+				num_states *= radix;
+			}
+
+			num_dealt.resize(num_states);
+
+			vector<int> digits(groups.size(), 0);
+			for (std::size_t s = 1; s < num_states; ++s) {
+				// Increment the odometer, keeping track of the total.
+				int total = num_dealt[s - 1];
+				for (std::size_t g = 0; ; ++g) {
+					if (digits[g] < groups[g].count) {
+						++digits[g];
+						++total;
+						break;
+					}
+
+					total -= digits[g];
+					digits[g] = 0;
+				}
+
+				num_dealt[s] = total;
+			}
+		}
+
+		// Whether another card from group `g` can be dealt in `state`.
+		bool can_deal(std::size_t state, std::size_t g) const {
+			auto count = static_cast<std::size_t>(groups[g].count);
+			return (state / strides[g]) % (count + 1) < count;
+		}
+	};
+
+	// The total weight of the deals consistent with a set of role masks,
+	// together with the weight of each player having each role.
+	struct evaluation {
+		double total{0.0};
+		// Indexed by `player * num_roles + role`.
+		vector<double> weights{};
+	};
+
+	// Sum `forward[s] * backward[s + strides[g]]` over every state `s` in
+	// `[first, last)` from which a card in group `g` can be dealt, keeping a
+	// separate sum for each player and card group.
+	inline vector<double> sum_transitions(const deal_space & space,
+		const vector<double> & forward, const vector<double> & backward,
+		std::size_t num_players, std::size_t first, std::size_t last)
+	{
+		auto num_groups = space.groups.size();
+		vector<double> sums(num_players * num_groups, 0.0);
+
+		for (auto s = first; s < last; ++s) {
+			if (forward[s] == 0.0) continue;
+			auto p = static_cast<std::size_t>(space.num_dealt[s]);
+			if (p == num_players) continue;
+
+			for (std::size_t g = 0; g < num_groups; ++g) {
+				if (!space.can_deal(s, g)) continue;
+				sums[p * num_groups + g] += forward[s] * backward[s + space.strides[g]];
+			}
+		}
+
+		return sums;
+	}
+
+	// Sum over every deal of `space` in which each player is dealt a card
+	// that could end up as a role in their mask.
+	inline evaluation evaluate(const deal_space & space,
+		span<const role_mask> masks, std::size_t num_roles)
+	{
+		auto num_players = masks.size();
+		auto num_groups = space.groups.size();
+		auto num_states = space.num_states;
+
+		// The probability of each player's role being in their mask, given
+		// that they were dealt a card from each group.
+		vector<double> chance(num_players * num_groups, 0.0);
+		for (std::size_t p = 0; p < num_players; ++p) {
+			for (std::size_t g = 0; g < num_groups; ++g) {
+				auto& group = space.groups[g];
+				if ((group.support & masks[p]) == 0) continue;
+
+				double sum = 0.0;
+				for (std::size_t r = 0; r < num_roles; ++r) {
+					if (masks[p] & (role_mask{1} << r)) sum += group.role_probs[r];
+				}
+				chance[p * num_groups + g] = sum;
+			}
+		}
+
+		// The weight of reaching each state from the empty deal.
+		vector<double> forward(num_states, 0.0);
+		forward[0] = 1.0;
+
+		for (std::size_t s = 0; s + 1 < num_states; ++s) {
+			if (forward[s] == 0.0) continue;
+			auto p = static_cast<std::size_t>(space.num_dealt[s]);
+
+			for (std::size_t g = 0; g < num_groups; ++g) {
+				auto c = chance[p * num_groups + g];
+				if (c == 0.0 || !space.can_deal(s, g)) continue;
+				forward[s + space.strides[g]] += forward[s] * c;
+			}
+		}
+
+		// The weight of completing the deal from each state.
+		vector<double> backward(num_states, 0.0);
+		backward[num_states - 1] = 1.0;
+
+		for (auto s = num_states - 1; s-- > 0; ) {
+			auto p = static_cast<std::size_t>(space.num_dealt[s]);
+			double sum = 0.0;
+
+			for (std::size_t g = 0; g < num_groups; ++g) {
+				auto c = chance[p * num_groups + g];
+				if (c == 0.0 || !space.can_deal(s, g)) continue;
+				sum += c * backward[s + space.strides[g]];
+			}
+
+			backward[s] = sum;
+		}
+
+		evaluation result;
+		result.total = backward[0];
+		result.weights.assign(num_players * num_roles, 0.0);
+		if (result.total == 0.0) return result;
+
+		vector<double> sums;
+		auto num_threads = static_cast<std::size_t>(std::thread::hardware_concurrency());
+
+		if (num_states < min_states_for_threads || num_threads < 2) {
+			sums = sum_transitions(space, forward, backward, num_players, 0, num_states);
+		} else {
+			vector<std::future<vector<double>>> partial_sums;
+			auto chunk = (num_states + num_threads - 1) / num_threads;
+
+			for (std::size_t first = 0; first < num_states; first += chunk) {
+				auto last = std::min(first + chunk, num_states);
+				partial_sums.push_back(std::async(std::launch::async, [&, first, last] {
+					return sum_transitions(space, forward, backward, num_players, first, last);
+				}));
+			}
+
+			sums.assign(num_players * num_groups, 0.0);
+			for (auto& future: partial_sums) {
+				auto partial = future.get();
+				for (std::size_t i = 0; i < sums.size(); ++i) sums[i] += partial[i];
+			}
+		}
+
+		for (std::size_t p = 0; p < num_players; ++p) {
+			for (std::size_t g = 0; g < num_groups; ++g) {
+				auto sum = sums[p * num_groups + g];
+				if (sum == 0.0) continue;
+
+				auto& group = space.groups[g];
+				for (std::size_t r = 0; r < num_roles; ++r) {
+					if (masks[p] & (role_mask{1} << r)) {
+						result.weights[p * num_roles + r] += sum * group.role_probs[r];
+					}
+				}
+			}
+		}
+
+		return result;
+	}
+}
+
+namespace maf::core {
+	Public_info::Public_info(span<const Role::ID> role_ids,
+	                         span<const Wildcard::ID> wildcard_ids)
+	:
+		role_ids(role_ids.begin(), role_ids.end()),
+		wildcard_ids(wildcard_ids.begin(), wildcard_ids.end()),
+		revealed_roles(role_ids.size() + wildcard_ids.size())
+	{ }
+
+	Public_info::Public_info(const Game & game, bool wildcards_revealed)
+	: Public_info{game.role_ids(), game.wildcard_ids()} {
+		if (wildcards_revealed) {
+			wildcard_ids.clear();
+			for (const Role & role: game.random_roles()) {
+				role_ids.push_back(role.id());
+			}
+		}
+
+		for (const Player & player: game.players()) {
+			if (player.has_been_lynched() || player.has_been_kicked()) {
+				reveal_role(player.id(), player.role().id());
+			}
+		}
+	}
+
+	void Public_info::reveal_role(Player::ID player, Role::ID role) {
+		auto i = static_cast<std::size_t>(player);
+		if (i >= revealed_roles.size()) revealed_roles.resize(i + 1);
+		revealed_roles[i] = role;
+	}
+
+	void Public_info::publish(const Investigation & investigation) {
+		investigations.push_back({investigation.target.id(), investigation.result});
+	}
+
+	double Role_posterior::probability(Player::ID player, Role::ID role) const {
+		auto p = static_cast<std::size_t>(player);
+		if (p >= _num_players) throw Game::Player_not_found{player};
+
+		auto iter = util::find(_role_ids, role);
+		if (iter == _role_ids.end()) return 0.0;
+
+		auto r = static_cast<std::size_t>(iter - _role_ids.begin());
+		return _probabilities[p * _role_ids.size() + r];
+	}
+
+	vector<pair<Role::ID, double>> Role_posterior::distribution(Player::ID player) const {
+		auto p = static_cast<std::size_t>(player);
+		if (p >= _num_players) throw Game::Player_not_found{player};
+
+		vector<pair<Role::ID, double>> dist{};
+		for (std::size_t r = 0; r < _role_ids.size(); ++r) {
+			auto prob = _probabilities[p * _role_ids.size() + r];
+			if (prob > 0.0) dist.emplace_back(_role_ids[r], prob);
+		}
+
+		return dist;
+	}
+
+	Role_posterior infer_roles(const Public_info & info, const Rulebook & rulebook) {
+		using namespace _infer_roles_impl;
+
+		auto roles = rulebook.roles();
+		auto num_roles = roles.size();
+		auto num_players = info.num_players();
+
+		if (num_roles > max_roles) {
+			string msg = "Roles can only be inferred for rulebooks with at most ";
+			msg += std::to_string(max_roles);
+			msg += " roles.";
+
+			throw std::length_error{msg};
+		}
+
+		auto role_index = [&](Role::ID id) -> std::size_t {
+			for (std::size_t r = 0; r < num_roles; ++r) {
+				if (roles[r].get().id() == id) return r;
+			}
+
+			throw Rulebook::Missing_role_ID{id};
+		};
+
+		auto bit = [](std::size_t r) { return role_mask{1} << r; };
+
+		role_mask all_roles = 0;
+		role_mask suspicious_roles = 0;
+		role_mask peddling_roles = 0;
+
+		for (std::size_t r = 0; r < num_roles; ++r) {
+			const Role & role = roles[r];
+			all_roles |= bit(r);
+			if (role.is_suspicious()) suspicious_roles |= bit(r);
+			if (role.has_ability(Ability::ID::peddle)) peddling_roles |= bit(r);
+		}
+
+		// Group identical cards together.
+		vector<card_group> groups{};
+
+		std::map<Role::ID, int> rolecard_counts{};
+		for (auto id: info.role_ids) ++rolecard_counts[id];
+
+		for (auto [id, count]: rolecard_counts) {
+			auto r = role_index(id);
+			auto& group = groups.emplace_back(card_group{count, vector<double>(num_roles, 0.0), bit(r)});
+			group.role_probs[r] = 1.0;
+		}
+
+		std::map<Wildcard::ID, int> wildcard_counts{};
+		for (auto id: info.wildcard_ids) ++wildcard_counts[id];
+
+		for (auto [id, count]: wildcard_counts) {
+			auto& group = groups.emplace_back(card_group{count, vector<double>(num_roles, 0.0), 0});
+
+			for (auto [role_id, prob]: rulebook.get_wildcard(id).role_probabilities(rulebook)) {
+				auto r = role_index(role_id);
+				group.role_probs[r] = prob;
+				group.support |= bit(r);
+			}
+		}
+
+		// Work out which roles each player could have. A suspicious result
+		// might have been caused by drugs, so these are only applied to the
+		// "strict" masks.
+		vector<role_mask> strict_masks(num_players, all_roles);
+		vector<role_mask> relaxed_masks(num_players, all_roles);
+
+		for (std::size_t p = 0; p < info.revealed_roles.size(); ++p) {
+			if (!info.revealed_roles[p]) continue;
+			if (p >= num_players) throw Game::Player_not_found{static_cast<Player::ID>(p)};
+
+			auto r = role_index(*info.revealed_roles[p]);
+			strict_masks[p] &= bit(r);
+			relaxed_masks[p] &= bit(r);
+		}
+
+		bool any_suspicious_results = false;
+
+		for (auto& investigation: info.investigations) {
+			auto p = static_cast<std::size_t>(investigation.target);
+			if (p >= num_players) throw Game::Player_not_found{investigation.target};
+
+			if (investigation.result) {
+				strict_masks[p] &= suspicious_roles;
+				any_suspicious_results = true;
+			} else {
+				strict_masks[p] &= ~suspicious_roles;
+				relaxed_masks[p] &= ~suspicious_roles;
+			}
+		}
+
+		bool drugs_possible = any_suspicious_results && util::any_of(groups,
+			[&](const card_group & group) { return group.support & peddling_roles; });
+
+		deal_space space{move(groups)};
+		evaluation eval;
+
+		if (!drugs_possible) {
+			eval = evaluate(space, strict_masks, num_roles);
+		} else {
+			// Split the deals by whether any player could be peddling drugs:
+			//   (no peddler, strict) + (any, relaxed) - (no peddler, relaxed)
+			auto without_peddlers = [&](vector<role_mask> masks) {
+				for (auto& mask: masks) mask &= ~peddling_roles;
+				return masks;
+			};
+
+			auto strict_no_peddler = without_peddlers(strict_masks);
+			auto relaxed_no_peddler = without_peddlers(relaxed_masks);
+
+			auto f1 = std::async(std::launch::async, [&] {
+				return evaluate(space, strict_no_peddler, num_roles);
+			});
+			auto f2 = std::async(std::launch::async, [&] {
+				return evaluate(space, relaxed_no_peddler, num_roles);
+			});
+			auto e0 = evaluate(space, relaxed_masks, num_roles);
+			auto e1 = f1.get();
+			auto e2 = f2.get();
+
+			eval.total = e1.total + e0.total - e2.total;
+			eval.weights.resize(e0.weights.size());
+			for (std::size_t i = 0; i < eval.weights.size(); ++i) {
+				eval.weights[i] = std::max(0.0, e1.weights[i] + e0.weights[i] - e2.weights[i]);
+			}
+		}
+
+		if (!(eval.total > 0.0) || !std::isfinite(eval.total)) {
+			throw Role_posterior::Inconsistent_info{};
+		}
+
+		Role_posterior posterior;
+		posterior._num_players = num_players;
+		posterior._role_ids = util::transform_into<vector<Role::ID>>(roles,
+			[](const Role & role) { return role.id(); });
+		posterior._probabilities = move(eval.weights);
+
+		for (auto& prob: posterior._probabilities) prob /= eval.total;
+
+		return posterior;
+	}
+}
@@ -0,0 +1,121 @@
+#ifndef MAFIA_CORE_INFERENCE_H
+#define MAFIA_CORE_INFERENCE_H
+
+#include "../util/misc.hpp"
+#include "../util/optional.hpp"
+#include "../util/span.hpp"
+#include "../util/vector.hpp"
+
+#include "game.hpp"
+#include "player.hpp"
+#include "role.hpp"
+#include "rulebook.hpp"
+#include "wildcard.hpp"
+
+namespace maf::core {
+	/// The result of an investigation which has been made public, e.g. by
+	/// the detective announcing it to the rest of the town.
+	struct Published_investigation {
+		/// The player who was investigated.
+		Player::ID target;
+		/// `true` if the target appeared as suspicious, `false` otherwise.
+		bool result;
+	};
+
+	/// Everything that is publicly known about a game, from which the roles
+	/// of the players can be inferred.
+	struct Public_info {
+		/// The rolecards that the game was set up with.
+		vector<Role::ID> role_ids{};
+		/// The wildcards that the game was set up with, whose roles have not
+		/// been made public.
+		vector<Wildcard::ID> wildcard_ids{};
+		/// The role of each player, indexed by ID, if it has been revealed.
+		///
+		/// Players beyond the end of the vector are treated as unrevealed.
+		vector<optional<Role::ID>> revealed_roles{};
+		/// The investigation results that have been made public.
+		vector<Published_investigation> investigations{};
+
+		/// Create an empty set of public info.
+		Public_info() = default;
+
+		/// Create public info for a game set up with the given cards, where
+		/// nothing else is known yet.
+		Public_info(span<const Role::ID> role_ids,
+		            span<const Wildcard::ID> wildcard_ids);
+
+		/// Collect the public info from `game`. This consists of its setup,
+		/// together with the roles of any players who have been lynched or
+		/// kicked.
+		///
+		/// If `wildcards_revealed` is true, then the roles picked by the
+		/// game's wildcards are treated as if they were rolecards.
+		explicit Public_info(const Game & game, bool wildcards_revealed = false);
+
+		/// The number of players in the game.
+		std::size_t num_players() const {
+			return role_ids.size() + wildcard_ids.size();
+		}
+
+		/// Record that `player` has been revealed to have `role`.
+		void reveal_role(Player::ID player, Role::ID role);
+
+		/// Record that the result of `investigation` has been made public.
+		void publish(const Investigation & investigation);
+	};
+
+	/// The probability of each player having each role, conditioned on a set
+	/// of public info.
+	class Role_posterior {
+	public:
+		/// Exception signifying that no assignment of roles to players is
+		/// consistent with the public info.
+		struct Inconsistent_info { };
+
+		/// The number of players in the game.
+		std::size_t num_players() const { return _num_players; }
+
+		/// The probability that `player` has the role with ID `role`.
+		///
+		/// Returns zero if `role` is not in the rulebook.
+		double probability(Player::ID player, Role::ID role) const;
+
+		/// The probability of `player` having each role, in the order that
+		/// the roles appear in the rulebook. Roles which `player` cannot
+		/// have are left out.
+		vector<pair<Role::ID, double>> distribution(Player::ID player) const;
+
+	private:
+		std::size_t _num_players{0};
+		vector<Role::ID> _role_ids{};
+		vector<double> _probabilities{};
+
+		friend Role_posterior infer_roles(const Public_info & info,
+		                                  const Rulebook & rulebook);
+	};
+
+	/// Compute the posterior role distribution of every player, given the
+	/// public info `info` about a game being run with `rulebook`.
+	///
+	/// Cards are assumed to have been dealt uniformly at random, with each
+	/// wildcard picking its role independently. Rather than enumerating
+	/// every deal, cards with the same ID are grouped together and the deals
+	/// are summed over using dynamic programming. The cost is proportional
+	/// to the product of `(count + 1)` over each distinct card, which stays
+	/// in the tens of thousands for games of around 15 players.
+	///
+	/// A suspicious investigation result is only taken as proof that the
+	/// target is suspicious in deals where no player has a role able to
+	/// peddle drugs. Otherwise it is ignored, since the target could have
+	/// been drugged.
+	///
+	/// @throws `Role_posterior::Inconsistent_info` if no assignment of roles
+	/// is consistent with `info`.
+	/// @throws `std::length_error` if the rulebook has more than 32 roles,
+	/// or if the product of `(count + 1)` over each distinct card is more
+	/// than 2^22.
+	Role_posterior infer_roles(const Public_info & info, const Rulebook & rulebook);
+}
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef MAFIA_CORE_RANDOM_H
+#define MAFIA_CORE_RANDOM_H
+
+#include <array>
+#include <cstdint>
+#include <random>
+
+namespace maf::core {
+	/// The streams of random numbers used to run a game, one for each
+	/// purpose that randomness is needed for.
+	///
+	/// Keeping the streams separate means that two games created from the
+	/// same seed make the same random choices for each purpose, even if
+	/// they draw a different amount of randomness for other purposes. For
+	/// example, two setups differing only in a duelling role deal their
+	/// cards in the same way. This allows variants of a game to be compared
+	/// using common random numbers.
+	class Random_streams {
+	public:
+		using Seed = std::uint64_t;
+		using Generator = std::default_random_engine;
+
+		/// The purposes that a game needs random numbers for.
+		enum class Purpose {
+			/// Shuffling the cards before they are dealt.
+			deal,
+			/// Picking the roles of wildcards.
+			wildcard,
+			/// Deciding the outcome of duels.
+			duel,
+			/// Picking the victims of ghosts.
+			haunt
+		};
+
+		/// The number of purposes. Streams with numbers from this value
+		/// upwards are not used by games, and are free to be used by
+		/// anything else that wants to share a seed with a game.
+		static constexpr std::uint32_t num_purposes = 4;
+
+		/// Create a set of streams with a seed taken from
+		/// `std::random_device`.
+		Random_streams() : Random_streams{random_seed()} { }
+
+		/// Create a set of streams from the given seed.
+		explicit Random_streams(Seed seed) : _seed{seed} {
+			for (std::uint32_t i = 0; i < num_purposes; ++i) {
+				_generators[i] = make_generator(seed, i);
+			}
+		}
+
+		/// The seed that the streams were created from.
+		Seed seed() const { return _seed; }
+
+		/// The generator used for `purpose`.
+		Generator & operator()(Purpose purpose) {
+			return _generators[static_cast<std::size_t>(purpose)];
+		}
+
+		/// A fresh seed taken from `std::random_device`.
+		static Seed random_seed() {
+			std::random_device device{};
+			return (Seed{device()} << 32) | Seed{device()};
+		}
+
+		/// A generator for stream number `stream` of `seed`.
+		static Generator make_generator(Seed seed, std::uint32_t stream) {
+			auto low = static_cast<std::uint32_t>(seed);
+			auto high = static_cast<std::uint32_t>(seed >> 32);
+			std::seed_seq seq{low, high, stream};
+			return Generator{seq};
+		}
+
+	private:
+		Seed _seed;
+		std::array<Generator, num_purposes> _generators{};
+	};
+}
+
+#endif
@@ -64,6 +64,12 @@ namespace maf::core {
 	}
 
 	const Role & Wildcard::pick_role(const Rulebook & rulebook) const {
+		return pick_role(rulebook, util::random::default_generator);
+	}
+
+	const Role & Wildcard::pick_role(const Rulebook & rulebook,
+	                                 std::default_random_engine & generator) const
+	{
 		if (uses_evaluator()) {
 			vector_of_refs<const Role> roles{};
 			vector<double> weights{};
@@ -97,15 +103,60 @@ namespace maf::core {
 				throw std::logic_error{msg};
 			}
 
-			return *util::random::pick(roles, weights);
+			return *util::random::pick(roles, weights, generator);
 		} else {
 			auto& mut_dist = const_cast<std::discrete_distribution<index> &>(_dist);
-			auto i = mut_dist(util::random::default_generator);
+			auto i = mut_dist(generator);
 			auto role_id = _role_ids[i];
 			return rulebook.look_up(role_id);
 		}
 	}
 
+	std::map<Role::ID, double> Wildcard::role_probabilities(const Rulebook & rulebook) const {
+		std::map<Role::ID, double> probs{};
+
+		if (uses_evaluator()) {
+			double total = 0.0;
+
+			rulebook.for_each_role([&](const Role & role) {
+				double w = _evaluator(role);
+
+				if (w < 0.0) {
+					string msg = "A wildcard with alias ";
+					msg += alias();
+					msg += " returned the negative role weight of ";
+					msg += std::to_string(w);
+					msg += " for the role with alias ";
+					msg += role.alias();
+					msg += ".";
+
+					throw std::logic_error{msg};
+				} else if (w > 0.0) {
+					probs[role.id()] = w;
+					total += w;
+				}
+			});
+
+			if (probs.empty()) {
+				string msg = "A wildcard with alias ";
+				msg += alias();
+				msg += " chose zero as the weight of every role in the rulebook.";
+
+				throw std::logic_error{msg};
+			}
+
+			for (auto& [_, p]: probs) p /= total;
+		} else {
+			auto dist_probs = _dist.probabilities();
+
+			for (index i = 0, n = _role_ids.size(); i < n; ++i) {
+				if (dist_probs[i] > 0.0) probs[_role_ids[i]] += dist_probs[i];
+			}
+		}
+
+		return probs;
+	}
+
 	string_view alias(Wildcard::ID id) {
 		switch (id) {
 		case Wildcard::ID::any:
@@ -60,6 +60,17 @@ namespace maf::core {
 		/// must be defined in `rulebook`.
 		const Role & pick_role(const Rulebook & rulebook) const;
 
+		/// Choose a role from `rulebook` as for `pick_role(rulebook)`, drawing
+		/// random numbers from `generator`.
+		const Role & pick_role(const Rulebook & rulebook,
+		                       std::default_random_engine & generator) const;
+
+		/// The probability of each role in `rulebook` being chosen by
+		/// `pick_role`. Roles which can never be chosen are left out.
+		///
+		/// The same requirements apply to `rulebook` as for `pick_role`.
+		std::map<Role::ID, double> role_probabilities(const Rulebook & rulebook) const;
+
 	private:
 		ID _id;
 		Role_evaluator _evaluator{};
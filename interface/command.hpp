@@ -1,9 +1,15 @@
 #ifndef MAFIA_INTERFACE_COMMAND_H
 #define MAFIA_INTERFACE_COMMAND_H
 
+#include <cstddef>
+#include <initializer_list>
 #include <iterator>
+#include <utility>
 
 #include "../util/algorithm.hpp"
+#include "../util/optional.hpp"
+#include "../util/small_vector.hpp"
+#include "../util/span.hpp"
 #include "../util/string.hpp"
 #include "../util/vector.hpp"
 
@@ -12,26 +18,241 @@ namespace maf {
 	//
 	// Note that only views into an input string are stored; make sure that
 	// the lifetime of a command sequence doesn't exceed the input string!
-	using CmdSequence = vector<string_view>;
-
-	// Decide whether or not the sequence `seq` of string-like objects matches
-	// the array `arr` of commands, which is true exactly when
-	// `std::size(seq)` equals `std::size(arr)`, and at each position `i`,
-	// either `arr[i]` is a blank string or `seq[i]` equals `arr[i]`.
-	template <std::size_t N>
-	bool commands_match(const CmdSequence & seq, const string_view (&arr)[N]) {
-		auto eq = [](auto& s1, string_view s2) {
-			return std::empty(s2) || s1 == s2;
-		};
+	//
+	// Up to 8 commands are stored without allocating any memory, which is
+	// enough for every command that the console understands.
+	using CmdSequence = util::small_vector<string_view, 8>;
+
+	// The kinds of command which can fill a slot in a command pattern. The
+	// kind of a slot has no effect on which commands match it, but decides
+	// how it's completed as it's typed.
+	enum class CmdSlot {
+		// The name of a player, either in the current game or, if there is
+		// none, in the next game.
+		player,
+		// The alias of a role.
+		role,
+		// The alias of a wildcard.
+		wildcard,
+		// Anything else, such as the name of a new player.
+		text
+	};
+
+	// A single word in a pattern of commands. This is either a literal
+	// command, which must appear exactly, or a slot which any command can
+	// fill.
+	struct CmdWord {
+		constexpr CmdWord(const char * literal) : literal{literal} { }
+		constexpr CmdWord(string_view literal) : literal{literal} { }
+		constexpr CmdWord(CmdSlot slot) : slot{slot} { }
+
+		// The command which must appear, if this isn't a slot.
+		string_view literal{};
+		// The kind of command filling the slot, if this is a slot.
+		optional<CmdSlot> slot{};
+
+		bool is_slot() const { return slot.has_value(); }
+
+		// Whether `cmd` can appear in place of this word.
+		bool matches(string_view cmd) const {
+			return is_slot() || cmd == literal;
+		}
+	};
+
+	// A pattern of commands, as used by `CmdRouter`.
+	using CmdPattern = span<const CmdWord>;
+
+	// Write out `pattern` as it would be entered, with a placeholder such as
+	// `<player>` for each slot.
+	//
+	// # Example
+	// `{CmdSlot::player, "vote", CmdSlot::player}` is written as
+	// `"<player> vote <player>"`.
+	inline string describe(CmdPattern pattern) {
+		string str;
+
+		for (auto& word: pattern) {
+			if (!str.empty()) str += ' ';
 
-		return util::matches(seq, arr, eq);
+			if (!word.is_slot()) {
+				str += word.literal;
+				continue;
+			}
+
+			switch (*word.slot) {
+			case CmdSlot::player:
+				str += "<player>";
+				break;
+			case CmdSlot::role:
+				str += "<role>";
+				break;
+			case CmdSlot::wildcard:
+				str += "<wildcard>";
+				break;
+			case CmdSlot::text:
+				str += "<text>";
+				break;
+			}
+		}
+
+		return str;
 	}
 
+	// A table of the commands understood by screens of type `S`, each
+	// given by a pattern of commands and leading to a handler.
+	//
+	// A route can also have a guard, which decides from the state of the
+	// screen whether the route can currently be used. Since the same table
+	// is used both to handle commands and to list them, a screen's list of
+	// commands always agrees with the commands that it accepts.
+	//
+	// The patterns are stored in a trie keyed by their commands, so finding
+	// the route for a sequence of commands takes a single walk over the
+	// sequence, however many patterns there are. A command is matched
+	// against the literal commands of the patterns before the slots. If
+	// several routes have the same pattern, the first whose guard allows it
+	// is used.
+	template <typename S>
+	class CmdRouter {
+	public:
+		using handler = void (*)(S & screen, const CmdSequence & commands);
+		using guard = bool (*)(const S & screen);
+
+		// A pattern of commands, and the handler to use for it.
+		struct route {
+			vector<CmdWord> pattern;
+			handler handle;
+			// Decides whether the route can currently be used, or `nullptr`
+			// if it can always be used.
+			guard is_available{nullptr};
+
+			bool is_available_on(const S & screen) const {
+				return !is_available || is_available(screen);
+			}
+		};
+
+		CmdRouter() = default;
+
+		// Create a table from `routes`, added in order.
+		CmdRouter(std::initializer_list<route> routes) {
+			for (auto& r: routes) add(r);
+		}
+
+		// Add `r` to the table. If other routes have the same pattern, `r`
+		// is only used when none of their guards allow them.
+		void add(route r) {
+			std::size_t node = 0;
+
+			for (auto& word: r.pattern) {
+				node = _child(node, word);
+			}
+
+			_nodes[node].routes.push_back(_routes.size());
+			_routes.push_back(std::move(r));
+		}
+
+		// The route to use for `commands` on `screen`, or `nullptr` if there
+		// is none.
+		const route * find(const S & screen, const CmdSequence & commands) const {
+			auto index = _find(screen, 0, commands, 0);
+			return (index == npos) ? nullptr : &_routes[index];
+		}
+
+		// Handle `commands` on `screen`, if there's a route for them.
+		//
+		// # Returns
+		// Whether a route was found.
+		bool dispatch(S & screen, const CmdSequence & commands) const {
+			auto r = find(screen, commands);
+			if (r) r->handle(screen, commands);
+			return r != nullptr;
+		}
+
+		// Add the pattern of every route which can currently be used on
+		// `screen` to `patterns`, in the order that they were added.
+		void list(const S & screen, vector<CmdPattern> & patterns) const {
+			for (auto& r: _routes) {
+				if (r.is_available_on(screen)) patterns.push_back(r.pattern);
+			}
+		}
+
+		// Every route in the table, in the order that they were added.
+		span<const route> routes() const { return _routes; }
+
+	private:
+		static constexpr std::size_t npos = -1;
+
+		struct node {
+			// The literal commands following this node, sorted by command,
+			// together with the index of the node that each leads to.
+			vector<std::pair<string_view, std::size_t>> children{};
+			// The node following a slot, if any.
+			std::size_t slot{npos};
+			// The routes ending at this node, in the order that they were
+			// added.
+			vector<std::size_t> routes{};
+		};
+
+		vector<node> _nodes = vector<node>(1);
+		vector<route> _routes{};
+
+		// The index of the node following `word` from `parent`, which is
+		// created if it doesn't exist yet.
+		std::size_t _child(std::size_t parent, const CmdWord & word) {
+			auto new_node = _nodes.size();
+
+			if (word.is_slot()) {
+				if (_nodes[parent].slot != npos) return _nodes[parent].slot;
+				_nodes[parent].slot = new_node;
+			} else {
+				auto& children = _nodes[parent].children;
+				auto iter = std::lower_bound(children.begin(), children.end(), word.literal,
+					[](auto& child, string_view cmd) { return child.first < cmd; });
+
+				if (iter != children.end() && iter->first == word.literal) return iter->second;
+				children.insert(iter, {word.literal, new_node});
+			}
+
+			_nodes.emplace_back();
+			return new_node;
+		}
+
+		// The index of the route to use for `commands` from position `i`,
+		// starting at `node`, or `npos` if there is none.
+		std::size_t _find(const S & screen, std::size_t node,
+			const CmdSequence & commands, std::size_t i) const
+		{
+			auto& n = _nodes[node];
+
+			if (i == commands.size()) {
+				for (auto index: n.routes) {
+					if (_routes[index].is_available_on(screen)) return index;
+				}
+
+				return npos;
+			}
+
+			auto iter = std::lower_bound(n.children.begin(), n.children.end(), commands[i],
+				[](auto& child, string_view cmd) { return child.first < cmd; });
+
+			if (iter != n.children.end() && iter->first == commands[i]) {
+				auto index = _find(screen, iter->second, commands, i + 1);
+				if (index != npos) return index;
+			}
+
+			if (n.slot != npos) {
+				return _find(screen, n.slot, commands, i + 1);
+			} else {
+				return npos;
+			}
+		}
+	};
+
 	// Split the string contained in the range `{begin, end}` into a sequence
 	// of commands, delimited by spaces `' '` and tabs `'\t'`.
 	//
 	// # Returns
-	// A vector of views into the range. Make sure the return value doesn't
+	// A sequence of views into the range. Make sure the return value doesn't
 	// exceed the lifetime of the input range!
 	//
 	// # Example
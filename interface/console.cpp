@@ -1,7 +1,6 @@
 #include <charconv>
 #include <ctime>
 #include <iomanip>
-#include <sstream>
 #include <stdexcept>
 
 #include "../util/algorithm.hpp"
@@ -13,15 +12,34 @@
 #include "command.hpp"
 #include "console.hpp"
 #include "names.hpp"
+#include "resources.hpp"
 
 
 namespace maf {
 	Console::Console() : _setup_screen{*this} {
+		// Every rulebook uses the same aliases.
+		for (const core::Role & role: _setup_screen.rulebook().roles()) {
+			_role_aliases.add(role.alias());
+		}
+
+		for (const core::Wildcard & wildcard: _setup_screen.rulebook().wildcards()) {
+			_wildcard_aliases.add(wildcard.alias());
+		}
+
 		refresh_output();
 	}
 
 	bool Console::do_commands(const CmdSequence & commands) {
-		std::stringstream err{}; // Write an error here if something goes wrong.
+		if (!_apply_commands(commands)) return false;
+
+		refresh_output();
+		clear_error_message();
+		return true;
+	}
+
+	bool Console::_apply_commands(const CmdSequence & commands) {
+		// The path of the error message to show if something goes wrong.
+		string_view err{};
 		TextParams err_params = {}; // (include parameters for error message here)
 
 		try {
@@ -29,8 +47,6 @@ namespace maf {
 
 			/* FIXME: add  "list w", "list w v", "list w m", "list w f". */
 
-			/* FIXME: "add p A B C" should result in players A, B, C all being chosen. */
-
 			/* FIXME: enter "auto" to automatically choose enough random cards for the currently-selected players to start a new game. */
 
 			/* FIXME: list p random, a utility command to generate a list of the players in a game, in a random order.
@@ -42,41 +58,37 @@ namespace maf {
 		catch (const core::Rulebook::Missing_role_alias &e) {
 			err_params["alias"] = escaped(e.alias);
 
-			err << "=Invalid alias!=\n\nNo role could be found whose alias is `{alias}`.\nNote that aliases are case-sensitive.\n(enter `list roles` to see a list of each role and its alias.)";
+			err = "txt/errors/missing-role-alias.txt";
 		}
 		catch (const core::Rulebook::Missing_wildcard_alias &e) {
 			err_params["alias"] = escaped(e.alias);
 
-			err << "=Invalid alias!=\n\nNo wildcard could be found whose alias is `{alias}`.\nNote that aliases are case-sensitive.\n(enter `list w` to see a list of each wildcard and its alias.)";
+			err = "txt/errors/missing-wildcard-alias.txt";
 		}
 		catch (const core::Game::Kick_failed &e) {
 			err_params["player"] = escaped(_game_log->get_name(e.player));
 
-			err << "=Kick failed!=\n\n";
-
 			switch (e.reason) {
 			using Reason = core::Game::Kick_failed::Reason;
 			case Reason::game_ended:
-				err << "{player} could not be kicked from the game, because the game has already ended.";
+				err = "txt/errors/kick-failed/game-ended.txt";
 				break;
 			case Reason::bad_timing:
-				err << "Players can only be kicked from the game during the day.";
+				err = "txt/errors/kick-failed/bad-timing.txt";
 				break;
 			case Reason::already_kicked:
-				err << "{player} has already been kicked from the game";
+				err = "txt/errors/kick-failed/already-kicked.txt";
 				break;
 			}
 		}
 		catch (const core::Game::Lynch_failed &e) {
-			err << "=Lynch failed!=\n\n";
-
 			switch (e.reason) {
 			using Reason = core::Game::Lynch_failed::Reason;
 			case Reason::game_ended:
-				err << "The game has already ended.";
+				err = "txt/errors/lynch-failed/game-ended.txt";
 				break;
 			case Reason::bad_timing:
-				err << "A lynch cannot occur at this moment in time.";
+				err = "txt/errors/lynch-failed/bad-timing.txt";
 				break;
 			}
 		}
@@ -86,24 +98,22 @@ namespace maf {
 				err_params["target"] = escaped(_game_log->get_name(*(e.target)));
 			}
 
-			err << "=Lynch vote failed!=\n\n";
-
 			switch (e.reason) {
 			using Reason = core::Game::Lynch_vote_failed::Reason;
 			case Reason::game_ended:
-				err << "The game has already ended.";
+				err = "txt/errors/lynch-vote-failed/game-ended.txt";
 				break;
 			case Reason::bad_timing:
-				err << "No lynch votes can be cast at this moment in time.";
+				err = "txt/errors/lynch-vote-failed/bad-timing.txt";
 				break;
 			case Reason::voter_is_not_present:
-				err << "{voter} is unable to cast a lynch vote, as they are no longer present in the game.";
+				err = "txt/errors/lynch-vote-failed/voter-is-not-present.txt";
 				break;
 			case Reason::target_is_not_present:
-				err << "{voter} cannot cast a lynch vote against {target}, because {target} is no longer present in the game.";
+				err = "txt/errors/lynch-vote-failed/target-is-not-present.txt";
 				break;
 			case Reason::voter_is_target:
-				err << "A player cannot cast a lynch vote against themself.";
+				err = "txt/errors/lynch-vote-failed/voter-is-target.txt";
 				break;
 			}
 		}
@@ -111,66 +121,61 @@ namespace maf {
 			err_params["caster"] = escaped(_game_log->get_name(e.caster));
 			err_params["target"] = escaped(_game_log->get_name(e.target));
 
-			err << "=Duel failed!=\n\n";
-
 			switch (e.reason) {
 			using Reason = core::Game::Duel_failed::Reason;
 			case Reason::game_ended:
-				err << "The game has already ended.";
+				err = "txt/errors/duel-failed/game-ended.txt";
 				break;
 			case Reason::bad_timing:
-				err << "A duel can only take place during the day.";
+				err = "txt/errors/duel-failed/bad-timing.txt";
 				break;
 			case Reason::caster_is_not_present:
-				err << "{caster} is unable to initiate a duel, as they are no longer present in the game.";
+				err = "txt/errors/duel-failed/caster-is-not-present.txt";
 				break;
 			case Reason::target_is_not_present:
-				err << "{caster} cannot initiate a duel against {target}, because {target} is no longer present in the game.";
+				err = "txt/errors/duel-failed/target-is-not-present.txt";
 				break;
 			case Reason::caster_is_target:
-				err << "A player cannot duel themself.";
+				err = "txt/errors/duel-failed/caster-is-target.txt";
 				break;
 			case Reason::caster_has_no_duel:
-				err << "{caster} has no duel ability to use.";
+				err = "txt/errors/duel-failed/caster-has-no-duel.txt";
 				break;
 			case Reason::bad_probability:
-				err << "An error occurred when calculating the probabilities needed to simulate the duel.";
+				err = "txt/errors/duel-failed/bad-probability.txt";
 				break;
 			}
 		}
 		catch (const core::Game::Begin_night_failed &e) {
-			err << "=Cannot begin night!=\n\n";
-
 			switch (e.reason) {
 			using Reason = core::Game::Begin_night_failed::Reason;
 			case Reason::game_ended:
-				err << "The game has ended, and so cannot be continued.\n(enter `end` to return to the game setup screen.)";
+				err = "txt/errors/begin-night-failed/game-ended.txt";
 				break;
 			case Reason::already_night:
-				err << "It is already nighttime.";
+				err = "txt/errors/begin-night-failed/already-night.txt";
+				break;
 			case Reason::lynch_can_occur:
-				err << "The next night cannot begin until a lynch has taken place.\n(enter `lynch` to submit the current lynch votes.)";
+				err = "txt/errors/begin-night-failed/lynch-can-occur.txt";
 				break;
 			}
 		}
 		catch (const core::Game::Choose_fake_role_failed &e) {
 			err_params["player"] = escaped(_game_log->get_name(e.player));
 
-			err << "=Choose fake role failed!=\n\n";
-
 			switch (e.reason) {
 			using Reason = core::Game::Choose_fake_role_failed::Reason;
 			case Reason::game_ended:
-				err << "The game has already ended.";
+				err = "txt/errors/choose-fake-role-failed/game-ended.txt";
 				break;
 			case Reason::bad_timing:
-				err << "Wait until night before choosing a fake role.";
+				err = "txt/errors/choose-fake-role-failed/bad-timing.txt";
 				break;
 			case Reason::player_is_not_faker:
-				err << "{player} doesn't need to be given a fake role.";
+				err = "txt/errors/choose-fake-role-failed/player-is-not-faker.txt";
 				break;
 			case Reason::already_chosen:
-				err << "{player} has already been given a fake role.";
+				err = "txt/errors/choose-fake-role-failed/already-chosen.txt";
 				break;
 			}
 		}
@@ -178,30 +183,28 @@ namespace maf {
 			err_params["caster"] = escaped(_game_log->get_name(e.caster));
 			err_params["target"] = escaped(_game_log->get_name(e.target));
 
-			err << "=Mafia kill failed!=\n\n";
-
 			switch (e.reason) {
 			using Reason = core::Game::Mafia_kill_failed::Reason;
 			case Reason::game_ended:
-				err << "The game has already ended.";
+				err = "txt/errors/mafia-kill-failed/game-ended.txt";
 				break;
 			case Reason::bad_timing:
-				err << "The mafia can only use their kill during the night.";
+				err = "txt/errors/mafia-kill-failed/bad-timing.txt";
 				break;
 			case Reason::already_used:
-				err << "Either the mafia have already used their kill this night, or there are no members of the mafia remaining to perform a kill.";
+				err = "txt/errors/mafia-kill-failed/already-used.txt";
 				break;
 			case Reason::caster_is_not_present:
-				err << "{caster} cannot perform the mafia's kill, as they are no longer in the game.";
+				err = "txt/errors/mafia-kill-failed/caster-is-not-present.txt";
 				break;
 			case Reason::caster_is_not_in_mafia:
-				err << "{caster} cannot perform the mafia's kill, as they are not part of the mafia.";
+				err = "txt/errors/mafia-kill-failed/caster-is-not-in-mafia.txt";
 				break;
 			case Reason::target_is_not_present:
-				err << "{target} cannot be targetted to kill by the mafia, as they are no longer in the game.";
+				err = "txt/errors/mafia-kill-failed/target-is-not-present.txt";
 				break;
 			case Reason::caster_is_target:
-				err << "{caster} is not allowed to kill themself.\n(nice try.)";
+				err = "txt/errors/mafia-kill-failed/caster-is-target.txt";
 				break;
 			}
 		}
@@ -209,21 +212,19 @@ namespace maf {
 			err_params["caster"] = escaped(_game_log->get_name(e.caster));
 			err_params["target"] = escaped(_game_log->get_name(e.target));
 
-			err << "=Kill failed!=\n\n";
-
 			switch (e.reason) {
 			using Reason = core::Game::Kill_failed::Reason;
 			case Reason::game_ended:
-				err << "The game has already ended.";
+				err = "txt/errors/kill-failed/game-ended.txt";
 				break;
 			case Reason::caster_cannot_kill:
-				err << "{caster} cannot use a kill ability right now.";
+				err = "txt/errors/kill-failed/caster-cannot-kill.txt";
 				break;
 			case Reason::target_is_not_present:
-				err << "{caster} cannot kill {target}, because {target} is no longer present in the game.";
+				err = "txt/errors/kill-failed/target-is-not-present.txt";
 				break;
 			case Reason::caster_is_target:
-				err << "{caster} is not allowed to kill themself.\n(nice try.)";
+				err = "txt/errors/kill-failed/caster-is-target.txt";
 				break;
 		}
 		}
@@ -231,21 +232,19 @@ namespace maf {
 			err_params["caster"] = escaped(_game_log->get_name(e.caster));
 			err_params["target"] = escaped(_game_log->get_name(e.target));
 
-			err << "=Heal failed!=\n\n";
-
 			switch (e.reason) {
 			using Reason = core::Game::Heal_failed::Reason;
 			case Reason::game_ended:
-				err << "The game has already ended.";
+				err = "txt/errors/heal-failed/game-ended.txt";
 				break;
 			case Reason::caster_cannot_heal:
-				err << "{caster} cannot use a heal ability right now.";
+				err = "txt/errors/heal-failed/caster-cannot-heal.txt";
 				break;
 			case Reason::target_is_not_present:
-				err << "{caster} cannot heal {target}, because {target} is no longer present in the game.";
+				err = "txt/errors/heal-failed/target-is-not-present.txt";
 				break;
 			case Reason::caster_is_target:
-				err << "{caster} is not allowed to heal themself.";
+				err = "txt/errors/heal-failed/caster-is-target.txt";
 				break;
 			}
 		}
@@ -253,21 +252,19 @@ namespace maf {
 			err_params["caster"] = escaped(_game_log->get_name(e.caster));
 			err_params["target"] = escaped(_game_log->get_name(e.target));
 
-			err << "=Investigation failed!=\n\n";
-
 			switch (e.reason) {
 			using Reason = core::Game::Investigate_failed::Reason;
 			case Reason::game_ended:
-				err << "The game has already ended.";
+				err = "txt/errors/investigate-failed/game-ended.txt";
 				break;
 			case Reason::caster_cannot_investigate:
-				err << "{caster} cannot investigate anybody right now.";
+				err = "txt/errors/investigate-failed/caster-cannot-investigate.txt";
 				break;
 			case Reason::target_is_not_present:
-				err << "{caster} cannot investigate {target}, because {target} is no longer present in the game.";
+				err = "txt/errors/investigate-failed/target-is-not-present.txt";
 				break;
 			case Reason::caster_is_target:
-				err << "{caster} is not allowed to investigate themself.";
+				err = "txt/errors/investigate-failed/caster-is-target.txt";
 				break;
 			}
 		}
@@ -275,100 +272,141 @@ namespace maf {
 			err_params["caster"] = escaped(_game_log->get_name(e.caster));
 			err_params["target"] = escaped(_game_log->get_name(e.target));
 
-			err << "=Peddle failed!=\n\n";
-
 			switch (e.reason) {
 			using Reason = core::Game::Peddle_failed::Reason;
 			case Reason::game_ended:
-				err << "The game has already ended.";
+				err = "txt/errors/peddle-failed/game-ended.txt";
 				break;
 			case Reason::caster_cannot_peddle:
-				err << "{caster} cannot use this ability right now.";
+				err = "txt/errors/peddle-failed/caster-cannot-peddle.txt";
 				break;
 			case Reason::target_is_not_present:
-				err << "{caster} cannot target {target}, because {target} is no longer present in the game.";
+				err = "txt/errors/peddle-failed/target-is-not-present.txt";
 				break;
 			case Reason::caster_is_target:
-				err << "{caster} is not allowed to target themself.";
+				err = "txt/errors/peddle-failed/caster-is-target.txt";
 				break;
 			}
 		}
 		catch (const core::Game::Skip_failed &e) {
-			err << "=Skip failed!=\n\nThe current ability, if one is showing, cannot be skipped.";
+			err = "txt/errors/skip-failed.txt";
 		}
 		catch (const Game_log::Players_to_cards_mismatch &e) {
-			err << "=Mismatch!=\n\nA new game cannot begin with an unequal number of players and cards.";
+			err = "txt/errors/players-to-cards-mismatch.txt";
 		}
 		catch (const Game_log::Player_not_found &e) {
 			err_params["player"] = escaped(e.name);
+			_set_suggestion_params(err_params, e.suggestions);
 
-			err << "=Player not found!=\n\nA player named `{player}` could not be found.";
+			err = "txt/errors/player-not-found.txt";
 		}
 		catch (const Screen::Bad_commands &e) {
-			err << "=Unrecognised input!=\n\nThe text that you entered couldn't be recognised.\n(enter `help` if you're unsure what to do.)";
+			err = "txt/errors/unrecognised-input.txt";
 		}
 		catch (const Setup_screen::Bad_player_name &e) {
-			err << "=Invalid name!=\n\nThe name of a player can only contain letters and numbers.";
+			err = "txt/errors/bad-player-name.txt";
 		}
 		catch (const Setup_screen::Player_already_exists &e) {
 			err_params["player"] = escaped(e.name);
 
-			err << "=Player already exists!=\n\nA player named `{player}` has already been selected to play in the next game.\nNote that names are case-insensitive.)";
+			err = "txt/errors/player-already-exists.txt";
 		}
 		catch (const Setup_screen::Player_missing &e) {
 			err_params["player"] = escaped(e.name);
+			_set_suggestion_params(err_params, e.suggestions);
 
-			err << "=Missing player!=\n\nA player named `{player}` could not be found.";
+			err = "txt/errors/player-missing.txt";
 		}
 		catch (const Setup_screen::Rolecard_unselected &e) {
 			err_params["alias"] = escaped(e.role.alias());
 
-			err << "=Rolecard not selected!=\n\nNo copies of the rolecard with alias `{alias}` have been selected.";
+			err = "txt/errors/rolecard-unselected.txt";
 		}
 		catch (const Setup_screen::Wildcard_unselected &e) {
 			err_params["alias"] = escaped(e.wildcard.alias());
 
-			err << "=Wildcard not selected!=\n\nNo copies of the wildcard with alias `{alias}` have been selected.";
+			err = "txt/errors/wildcard-unselected.txt";
 		}
 		catch (const Setup_screen::Bad_commands &e) {
-			err << "=Unrecognised input!=\n\nThe text that you entered couldn't be recognised.\n(enter `help` if you're unsure what to do.)";
+			err = "txt/errors/unrecognised-input.txt";
 		}
 		catch (const Question::Bad_commands &e) {
-			err << "=Invalid input!=\n\nPlease answer the question being shown before trying to do anything else.";
+			err = "txt/errors/question-unanswered.txt";
 		}
 		catch (const No_game_in_progress &e) {
-			err << "=No game in progress!=\n\nThere is no game in progress at the moment, and so game-related commands cannot be used.\n(enter `begin` to begin a new game, or `help` for a list of usable commands.)";
+			err = "txt/errors/no-game-in-progress.txt";
 		}
 		catch (const Begin_game_failed &e) {
 			switch (e.reason) {
 				case Begin_game_failed::Reason::game_already_in_progress:
-					err << "=Game in progress!=\n\nA new game cannot begin until the current game ends.\n(enter `end` to force the game to end early, or if the game has already ended and you want to return to the game setup screen.)";
+					err = "txt/errors/game-already-in-progress.txt";
 					break;
 			}
 		}
 		catch (const Missing_preset &e) {
 			err_params["index"] = e.index;
 
-			err << "=Error!=\n\nThere is no preset defined for the index {index}.";
+			err = "txt/errors/missing-preset.txt";
 		}
 		catch (const Generic_error & error) {
-			err_params = error.params;
-			err << error.msg;
+			read_error_message(error.msg, error.params);
+			return false;
 		}
 
-		if (err.tellp() == 0) {
-			refresh_output();
-			clear_error_message();
+		if (err.empty()) {
 			return true;
 		} else {
-			read_error_message(err.str(), err_params);
+			_read_error_txt(err, err_params);
 			return false;
 		}
 	}
 
+	void Console::_set_suggestion_params(TextParams & params, const vector<string> & names) {
+		TextParamsList suggestions{params.get_allocator()};
+
+		for (auto& name: names) {
+			auto& subparams = suggestions.emplace_back();
+			subparams["name"] = escaped(name);
+		}
+
+		params["suggestions.size"] = static_cast<int>(suggestions.size());
+		params["suggestions"] = move(suggestions);
+	}
+
 	bool Console::input(string_view input) {
-		auto v = parse_input(input);
-		return do_commands(v);
+		if (input.find_first_of(";\n") == string_view::npos) {
+			return do_commands(parse_input(input));
+		}
+
+		// Apply each command in turn, but only refresh the output once they
+		// have all been applied, or once one of them has failed.
+		bool any_applied = false;
+
+		while (true) {
+			auto end = input.find_first_of(";\n");
+			auto commands = parse_input(input.substr(0, end));
+
+			if (!commands.empty()) {
+				if (!_apply_commands(commands)) {
+					if (any_applied) refresh_output();
+					return false;
+				}
+
+				any_applied = true;
+			}
+
+			if (end == string_view::npos) break;
+			input.remove_prefix(end + 1);
+		}
+
+		if (!any_applied) {
+			// Treat a blank batch in the same way as a blank command.
+			return do_commands({});
+		}
+
+		refresh_output();
+		clear_error_message();
+		return true;
 	}
 
 	const StyledText & Console::output() const {
@@ -384,25 +422,171 @@ namespace maf {
 			msg += " in the following string:\n\n";
 
 			_output.clear();
-			_output.emplace_back("Error!", StyledString::title_attributes);
-			_output.emplace_back(msg, StyledString::default_attributes);
-			_output.emplace_back(string{error.input}, StyledString::monospace_attributes);
+			_output.append("Error!", StyledString::title_attributes);
+			_output.append(msg, StyledString::default_attributes);
+			_output.append(error.input, StyledString::monospace_attributes);
 		}
 	}
 
 	void Console::refresh_output() {
+		if (_track_output_changes) {
+			_previous_output = std::move(_output);
+			_refresh_output();
+			_output_changes = diff(_previous_output, _output);
+		} else {
+			_refresh_output();
+		}
+	}
+
+	void Console::track_output_changes(bool track) {
+		_track_output_changes = track;
+		_previous_output.clear();
+		_output_changes.clear();
+	}
+
+	span<const StyledTextEdit> Console::output_changes() const {
+		return _output_changes;
+	}
+
+	void Console::_refresh_output() {
+		const Screen & screen = active_screen();
+		auto serial = screen.serial();
+		auto state_version = screen.state_version();
+
+		auto iter = util::find_if(_recent_outputs, [&](const Recent_output & recent) {
+			return recent.serial == serial && recent.state_version == state_version;
+		});
+
+		if (iter != _recent_outputs.end()) {
+			_output = iter->output;
+			std::rotate(_recent_outputs.begin(), iter, iter + 1);
+			return;
+		}
+
+		_write_output(screen);
+
+		if (_recent_outputs.size() == _max_recent_outputs) {
+			_recent_outputs.pop_back();
+		}
+
+		_recent_outputs.insert(_recent_outputs.begin(),
+			{serial, state_version, _output});
+	}
+
+	void Console::_write_output(const Screen & screen) {
+		// Format the screen as it's written. If something goes wrong, write
+		// the whole screen out first instead, so that the error can be
+		// described properly.
+		try {
+			StyledTextWriter writer{};
+			screen.write(writer);
+			writer.drop_whitespace_from_end();
+			_output = writer.finish();
+			return;
+		} catch (const preprocess_text_error &) {
+		} catch (const format_text_error &) {
+		}
+
 		string str;
-		active_screen().write(str);
+		screen.write(str);
 		auto substr = util::drop_whitespace_from_end(str);
 		read_output(substr);
 	}
 
+	vector<string_view> Console::complete(string_view partial, std::size_t max_results) const {
+		auto words = parse_input(partial);
+
+		// The word being completed, which is empty if a new word is about to
+		// be typed.
+		string_view prefix{};
+		auto num_before = words.size();
+
+		if (!words.empty() && partial.back() != ' ' && partial.back() != '\t') {
+			prefix = words.back();
+			--num_before;
+		}
+
+		auto starts_with_prefix = [&](string_view word) {
+			return word.size() >= prefix.size()
+				&& util::equal_up_to_case(word.substr(0, prefix.size()), prefix);
+		};
+
+		vector<CmdPattern> patterns;
+		active_screen().list_commands(patterns);
+
+		vector<string_view> results;
+		// The kinds of slot which could come next, in the order found.
+		vector<CmdSlot> slots;
+
+		for (auto pattern: patterns) {
+			if (pattern.size() <= num_before) continue;
+
+			bool matches = true;
+
+			for (std::size_t i = 0; i < num_before; ++i) {
+				if (!pattern[i].is_slot() && !util::equal_up_to_case(pattern[i].literal, words[i])) {
+					matches = false;
+					break;
+				}
+			}
+
+			if (!matches) continue;
+
+			auto& word = pattern[num_before];
+
+			if (word.is_slot()) {
+				if (util::find(slots, *word.slot) == slots.end()) slots.push_back(*word.slot);
+			} else if (starts_with_prefix(word.literal) && util::find(results, word.literal) == results.end()) {
+				results.push_back(word.literal);
+			}
+		}
+
+		std::sort(results.begin(), results.end());
+		if (results.size() > max_results) results.resize(max_results);
+
+		// Slots containing free text have nothing to complete.
+		auto names_for = [&](CmdSlot slot) -> const Name_trie * {
+			switch (slot) {
+			case CmdSlot::player:
+				return has_game() ? &game_log().player_trie() : &_setup_screen.player_trie();
+			case CmdSlot::role:
+				return &_role_aliases;
+			case CmdSlot::wildcard:
+				return &_wildcard_aliases;
+			case CmdSlot::text:
+				return nullptr;
+			}
+
+			return nullptr;
+		};
+
+		for (auto slot: {CmdSlot::player, CmdSlot::role, CmdSlot::wildcard}) {
+			if (results.size() == max_results) break;
+			if (util::find(slots, slot) == slots.end()) continue;
+
+			auto names = names_for(slot)->complete(prefix, max_results - results.size());
+			results.insert(results.end(), names.begin(), names.end());
+		}
+
+		return results;
+	}
+
 	const StyledText & Console::error_message() const {
 		return _error_message;
 	}
 
 	void Console::read_error_message(string_view raw_err_msg, const TextParams & params) {
 		// TODO: Catch exceptions when preprocessing the text.
+		try {
+			StyledTextWriter writer{};
+			preprocess_text(raw_err_msg, params, writer);
+			_error_message = writer.finish();
+			return;
+		} catch (const format_text_error &) {
+			// Format the whole message in one go instead, so that the error
+			// refers to the message rather than a part of it.
+		}
+
 		auto preprocessed_err_msg = preprocess_text(raw_err_msg, params);
 
 		// TODO: Catch exceptions when formatting the text.
@@ -411,6 +595,32 @@ namespace maf {
 		_error_message = format_text(preprocessed_err_msg);
 	}
 
+	void Console::_read_error_txt(string_view path, TextParams const& params) {
+		// Error messages are usually compiled into the application, so they
+		// only need their parameters filled in.
+		if (!resources::is_overridden(path)) {
+			if (auto compiled = find_compiled_template(path)) {
+				try {
+					StyledTextWriter writer{};
+					compiled->render(writer, params);
+					_error_message = writer.finish();
+					return;
+				} catch (const preprocess_text_error &) {
+				} catch (const format_text_error &) {
+				}
+			}
+		}
+
+		if (auto resource = resources::load(path)) {
+			read_error_message(resource->str(), params);
+		} else {
+			string msg = "=Error!=\n\nERROR: No text found for the error message at `";
+			msg += escaped(path);
+			msg += "`.";
+			read_error_message(msg);
+		}
+	}
+
 	void Console::clear_error_message() {
 		_error_message.clear();
 	}
@@ -445,9 +655,8 @@ namespace maf {
 			ofs << std::put_time(std::localtime(&t), "%F %T");
 			ofs << " ======\n\n";
 
-			string transcript;
-			_game_log->write_transcript(transcript);
-			ofs << transcript;
+			StreamSink sink{ofs};
+			_game_log->write_transcript(sink);
 
 			_game_log.reset();
 		}
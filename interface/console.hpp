@@ -2,9 +2,12 @@
 #define MAFIA_INTERFACE_CONSOLE_H
 
 #include <concepts>
+#include <cstdint>
 
 #include "../util/memory.hpp"
 #include "../util/misc.hpp"
+#include "../util/span.hpp"
+#include "../util/vector.hpp"
 
 #include "command.hpp"
 #include "format.hpp"
@@ -50,10 +53,15 @@ namespace maf {
 		// Process the given input string, by seperating it into commands
 		// delimited by whitespace. For example, the input "add p Brutus" becomes
 		// {"add", "p", "Brutus"}.
+		// The input may hold several lines of commands, separated by ';' or by
+		// newlines. These are applied in order, stopping at the first line
+		// that fails, and the output is only refreshed once at the end. Blank
+		// lines are skipped.
 		// Returns true if the input was accepted. In this case, error_message()
 		// is empty.
 		// Returns false if the input is invalid for some reason. In this case,
-		// output() remains unchanged and error_message() is non-empty.
+		// error_message() is non-empty, and output() only shows the effects of
+		// the lines before the one that failed.
 		bool input(string_view input);
 
 		// The most recent output. Never empty.
@@ -61,8 +69,30 @@ namespace maf {
 		// Format the given contents, updating the output to display the styled
 		// text obtained.
 		void read_output(string_view contents);
-		// Updates the output to display the appropriate screen.
+		// Updates the output to display the appropriate screen. If the screen
+		// was displayed recently and its state version hasn't changed since,
+		// the output from then is reused.
 		void refresh_output();
+		// Start or stop finding the changes made to the output each time
+		// that it's refreshed. Tracking is off by default.
+		void track_output_changes(bool track);
+		// The edits turning the output from before the last refresh into the
+		// current output, if changes are being tracked. Otherwise empty.
+		// The inserted segments are views into output().
+		span<const StyledTextEdit> output_changes() const;
+
+		// Find words which could complete the last word of `partial`, an
+		// input which is still being typed. If `partial` ends in whitespace,
+		// find words which could come after it instead.
+		//
+		// Commands which the active screen can handle come first, in
+		// alphabetical order. These are followed by whichever of the names of
+		// players, the aliases of roles and the aliases of wildcards could
+		// fill a slot coming next, going by the kind of the slot. Slots for
+		// free text, such as the name of a new player, aren't completed. At
+		// most `max_results` words are found. They remain valid until the
+		// next command is processed.
+		vector<string_view> complete(string_view partial, std::size_t max_results = 10) const;
 
 		// The most recent error message. Usually empty.
 		// The only styles that will ever appear here are help, help_title and
@@ -136,8 +166,44 @@ namespace maf {
 		const core::Rulebook & active_rulebook() const;
 
 	private:
+		// The output for a screen that was displayed recently.
+		struct Recent_output {
+			std::uint64_t serial;
+			std::uint64_t state_version;
+			StyledText output;
+		};
+
+		// The number of recent outputs to remember.
+		static constexpr std::size_t _max_recent_outputs = 4;
+
 		StyledText _output{};
 		StyledText _error_message{};
+		// Most recent first.
+		vector<Recent_output> _recent_outputs{};
+		// The aliases of every role and wildcard, for completing aliases as
+		// they're typed.
+		Name_trie _role_aliases{};
+		Name_trie _wildcard_aliases{};
+
+		bool _track_output_changes{false};
+		StyledText _previous_output{};
+		vector<StyledTextEdit> _output_changes{};
+
+		// Update the output to display the appropriate screen, without
+		// finding what has changed.
+		void _refresh_output();
+		// Apply `commands` to the active screen, without refreshing the
+		// output. If this fails, the error message is updated to explain why
+		// and false is returned.
+		bool _apply_commands(const CmdSequence & commands);
+		// Write `screen` out and format it, updating the output.
+		void _write_output(const Screen & screen);
+		// Set the parameters "suggestions" and "suggestions.size" for an
+		// error message, listing each of `names`.
+		static void _set_suggestion_params(TextParams & params, const vector<string> & names);
+		// Update the error message to display the template found at `path`
+		// among the resources, using `params`.
+		void _read_error_txt(string_view path, TextParams const& params);
 
 		Setup_screen _setup_screen;
 		unique_ptr<Game_log> _game_log{};
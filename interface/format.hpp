@@ -1,9 +1,14 @@
 #ifndef MAFIA_FORMAT
 #define MAFIA_FORMAT
 
-#include <map>
+#include <functional>
+#include <iterator>
+#include <memory_resource>
 
+#include "../util/iostream.hpp"
+#include "../util/memory.hpp"
 #include "../util/misc.hpp"
+#include "../util/span.hpp"
 #include "../util/string.hpp"
 #include "../util/variant.hpp"
 #include "../util/vector.hpp"
@@ -17,24 +22,216 @@ namespace maf {
 	// - `escaped("under_score")` returns `"under\_score"`
 	string escaped(string_view str_view);
 
+	// Somewhere that text can be written to, one chunk at a time.
+	class TextSink {
+	public:
+		virtual ~TextSink() = default;
+
+		// Write `chunk` after everything written so far.
+		virtual void write(string_view chunk) = 0;
+	};
+
+	// A sink appending everything written to it to a string.
+	class StringSink: public TextSink {
+	public:
+		explicit StringSink(string & str): _str{str} { }
+
+		void write(string_view chunk) override { _str += chunk; }
+
+	private:
+		string & _str;
+	};
+
+	// A sink writing everything written to it to an output stream, such as
+	// a file, as soon as it's written.
+	class StreamSink: public TextSink {
+	public:
+		explicit StreamSink(ostream & out): _out{out} { }
+
+		void write(string_view chunk) override {
+			_out.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+		}
+
+	private:
+		ostream & _out;
+	};
+
 	// forward declaration needed by TextParam
 	class TextParams;
 
+	// A list of text parameters, used by `{!list ...}` directives.
+	using TextParamsList = std::pmr::vector<TextParams>;
+
+	// A list of text parameters which are generated one item at a time, as
+	// a `{!list ...}` directive iterates over them. Only a single item exists
+	// at any one time, so no memory is needed for the list as a whole.
+	class TextParamsGenerator {
+	public:
+		// A function filling `item` with the parameters for the item at
+		// position `index` in the list. `item` is always empty beforehand.
+		using Fill = std::function<void(std::size_t index, TextParams & item)>;
+
+		TextParamsGenerator(std::size_t size, Fill fill)
+		: _size{size}, _fill{move(fill)} { }
+
+		// The number of items in the list.
+		std::size_t size() const { return _size; }
+
+		// Call `f` with the parameters for each item in the list, in order.
+		template <typename Function>
+		void for_each(Function && f) const;
+
+	private:
+		std::size_t _size;
+		Fill _fill;
+	};
+
 	// A single parameter used when preprocessing text.
-	class TextParam : public variant<bool, int, string, vector<TextParams>> {
+	//
+	// Strings and lists are allocated using the parameter's allocator, so
+	// that a whole set of parameters can be placed in a single arena.
+	//
+	// A parameter can also be lazy, in which case its value is computed by a
+	// provider the first time that it's read. Parameters are not safe to read
+	// from multiple threads at once for this reason.
+	class TextParam {
 	public:
-		using variant<bool, int, string, vector<TextParams>>::variant;
+		using allocator_type = std::pmr::polymorphic_allocator<>;
+		using string_type = std::pmr::string;
+		using value_type = variant<bool, int, string_type, TextParamsList,
+		                           TextParamsGenerator>;
+
+		// A function setting the value of a lazy parameter, by assigning to
+		// the parameter that it's given.
+		using Provider = std::function<void(TextParam & param)>;
+
+		TextParam() = default;
+		explicit TextParam(allocator_type alloc) : _alloc{alloc} { }
+		TextParam(const TextParam & other, allocator_type alloc);
+		TextParam(TextParam && other, allocator_type alloc);
+
+		TextParam(const TextParam & other);
+		TextParam(TextParam && other) = default;
+
+		TextParam & operator=(const TextParam & other);
+		TextParam & operator=(TextParam && other);
+
+		TextParam & operator=(bool b);
+		TextParam & operator=(int i);
+		TextParam & operator=(string_view str);
+		TextParam & operator=(const char * str) { return *this = string_view{str}; }
+
+		// Set the parameter to `list`. The list is moved if it uses the same
+		// allocator as this parameter, and copied otherwise.
+		TextParam & operator=(TextParamsList list);
+		TextParam & operator=(TextParamsGenerator generator);
+
+		// Make the parameter lazy, so that `provider` is called to set its
+		// value the first time that it's read.
+		void provide(Provider provider);
+
+		// The value of the parameter, calling its provider first if needed.
+		const value_type & value() const {
+			if (_provider) _resolve();
+			return _value;
+		}
+
+		allocator_type get_allocator() const { return _alloc; }
+
+	private:
+		mutable value_type _value{false};
+		mutable Provider _provider{};
+		allocator_type _alloc{};
+
+		void _resolve() const;
 	};
 
-	// A map from strings to text parameters.
+	// A map from strings to text parameters, stored as a vector sorted by key.
 	//
 	// Note that the map only holds views into its keys, whereas the values
 	// are fully owned. Typically each key will be a compile-time constant.
-	class TextParams : public std::map<string_view, TextParam> {
+	//
+	// The map and its values are allocated using a single allocator. Passing
+	// in a `std::pmr::monotonic_buffer_resource` allows every parameter for
+	// a screen to be built without touching the heap, with all of the memory
+	// released at once when the resource is destroyed. Lists should be
+	// created with `get_allocator()`, so that they share the same resource.
+	class TextParams {
 	public:
-		using std::map<string_view, TextParam>::map;
+		using allocator_type = std::pmr::polymorphic_allocator<>;
+		using value_type = pair<string_view, TextParam>;
+		using const_iterator = std::pmr::vector<value_type>::const_iterator;
+
+		TextParams() = default;
+		explicit TextParams(allocator_type alloc) : _entries{alloc} { }
+
+		TextParams(const TextParams & other, allocator_type alloc)
+		: _entries{other._entries, alloc} { }
+
+		TextParams(TextParams && other, allocator_type alloc)
+		: _entries{move(other._entries), alloc} { }
+
+		TextParams(const TextParams &) = default;
+		TextParams(TextParams &&) = default;
+		TextParams & operator=(const TextParams &) = default;
+		TextParams & operator=(TextParams &&) = default;
+
+		// Get the parameter whose key is `key`, inserting one first if there
+		// is none.
+		TextParam & operator[](string_view key);
+
+		// Find the parameter whose key is `key`, or return `end()` if there
+		// is none.
+		const_iterator find(string_view key) const;
+
+		// Make the parameter whose key is `key` lazy, using `provider` to set
+		// its value when it's first read. Does nothing if `key` is never read
+		// by the template that the parameters are for.
+		void provide(string_view key, TextParam::Provider provider);
+
+		// Note that only the parameters whose keys are in `keys` can be read
+		// by the template that these parameters are for, as found by
+		// `TextTemplate::param_names`. The keys must be sorted, and must
+		// outlive the parameters.
+		void restrict_to(span<const string_view> keys) {
+			_readable_keys = keys;
+			_restricted = true;
+		}
+
+		// Check if the parameter whose key is `key` can be read by the
+		// template that these parameters are for. This is always true unless
+		// `restrict_to` has been called.
+		bool can_be_read(string_view key) const;
+
+		const_iterator begin() const { return _entries.begin(); }
+		const_iterator end() const { return _entries.end(); }
+
+		std::size_t size() const { return _entries.size(); }
+		bool empty() const { return _entries.empty(); }
+
+		// Remove every parameter, keeping the memory allocated for them.
+		void clear() { _entries.clear(); }
+
+		allocator_type get_allocator() const { return _entries.get_allocator(); }
+
+	private:
+		std::pmr::vector<value_type> _entries;
+		span<const string_view> _readable_keys{};
+		bool _restricted{false};
 	};
 
+	template <typename Function>
+	void TextParamsGenerator::for_each(Function && f) const {
+		// Reuse a single set of parameters for every item.
+		TextParams item{};
+
+		for (std::size_t i = 0; i < _size; ++i) {
+			item.clear();
+			_fill(i, item);
+			f(std::as_const(item));
+		}
+	}
+
 	// Type for exceptions that can be thrown when calling `preprocess_text`.
 	struct preprocess_text_error {
 		enum class error_code {
@@ -134,6 +331,111 @@ namespace maf {
 	// for further information.
 	string preprocess_text(string_view input, TextParams const& params);
 
+	// Apply the directives in `input` in the same way as above, but write the
+	// result to `output` rather than returning it. Some of the result may
+	// already have been written when an exception is thrown.
+	void preprocess_text(string_view input, TextParams const& params,
+		TextSink & output);
+
+	namespace _preprocess_text_impl {
+		struct sequence;
+	}
+
+	// A text template which has been parsed once, so that it can be
+	// preprocessed against any number of sets of parameters without being
+	// parsed again.
+	//
+	// The parsed directives hold views into the template's source string,
+	// which is either a copy owned by the template or a string that outlives
+	// it. As such, errors thrown by `write` remain valid for as long as the
+	// template itself.
+	class TextTemplate {
+	public:
+		// Parse a copy of `source` into a template.
+		//
+		// # Exceptions
+		// Throws `preprocess_text_error` if `source` couldn't be parsed. The
+		// error refers to `source` itself rather than the template's copy.
+		explicit TextTemplate(string_view source);
+
+		// Parse `source` into a template without copying it. `source` must
+		// remain valid for as long as the template, as is the case for a
+		// resource compiled into the application or mapped from a pack.
+		//
+		// # Exceptions
+		// Throws `preprocess_text_error` if `source` couldn't be parsed.
+		static TextTemplate viewing(string_view source);
+
+		TextTemplate(TextTemplate &&) noexcept;
+		TextTemplate & operator=(TextTemplate &&) noexcept;
+		~TextTemplate();
+
+		// The string that the template was parsed from.
+		string_view source() const { return _source; }
+
+		// Apply the template's directives using `params`, in the same way as
+		// `preprocess_text`, and write the result to `output`.
+		//
+		// # Exceptions
+		// Throws `preprocess_text_error` if a parameter is missing or has
+		// the wrong type. Some of the output may already have been written
+		// to `output` when this happens.
+		void write(TextSink & output, TextParams const& params) const;
+
+		// Apply the template's directives as above, appending the result to
+		// `output`.
+		void write(string & output, TextParams const& params) const {
+			StringSink sink{output};
+			write(sink, params);
+		}
+
+		// Write C++ statements to `output` which have the same effect as
+		// `write`, for a template compiled at build time.
+		//
+		// The statements write to a `TextSink` named `output` using a
+		// `TextParams` named `params`, and call the helpers declared in
+		// "text/compiled.hpp". Parameter names are taken as substrings of a
+		// `string_view` named `source_var`, which must hold `source()`. Each
+		// statement is indented by `indent` tabs.
+		void write_cpp(string & output, string_view source_var, int indent) const;
+
+		// The names of every parameter that the template can read outside
+		// of a `{!list ...}` directive, in any branch, sorted and without
+		// duplicates. The names are views into `source()`.
+		span<const string_view> param_names() const { return _param_names; }
+
+	private:
+		// The copy of the source made by the template, if any. Held by
+		// pointer so that views into it survive moves.
+		unique_ptr<const string> _owned_source;
+		string_view _source;
+		unique_ptr<const _preprocess_text_impl::sequence> _expr;
+		vector<string_view> _param_names;
+
+		TextTemplate() = default;
+
+		// Parse `_source` into `_expr`. Errors are made to refer to
+		// `caller_source`, which must have the same contents.
+		void _parse(string_view caller_source);
+	};
+
+	// A template compiled into a function at build time.
+	struct CompiledTextTemplate {
+		// Has the same effect as calling `write` on the corresponding
+		// `TextTemplate`.
+		void (*render)(TextSink & output, TextParams const& params);
+		// The same as `param_names()` for the corresponding `TextTemplate`.
+		span<const string_view> param_names;
+	};
+
+	// Find the template compiled from the file at `path`, relative to the
+	// "resources" directory, e.g. `"txt/help/setup.txt"`.
+	//
+	// # Returns
+	// The compiled template, or `nullptr` if `path` isn't a template that
+	// was compiled into the application.
+	const CompiledTextTemplate * find_compiled_template(string_view path);
+
 
 	// A string coupled with a set of suggested attributes. Each attribute is
 	// intended to entail such properties as typeface, font size, colour, etc.
@@ -166,6 +468,8 @@ namespace maf {
 			weight_option weight;
 			typeface_option typeface;
 			semantics_option semantics;
+
+			bool operator==(const attributes_t &) const = default;
 		};
 
 		static constexpr attributes_t default_attributes = {};
@@ -197,8 +501,110 @@ namespace maf {
 		attributes_t attributes;
 	};
 
-	// A vector of styled strings, used to form a block of text.
-	using StyledText = vector<StyledString>;
+	// A view of a string in a `StyledText`, coupled with its attributes.
+	struct StyledStringView {
+		string_view str;
+		StyledString::attributes_t attributes;
+	};
+
+	// A sequence of styled strings, used to form a block of text.
+	//
+	// The characters of every string are stored contiguously in a single
+	// buffer, alongside a list of runs marking out where each string begins
+	// and ends. Iterating over the text gives a `StyledStringView` for each
+	// run, which is valid for as long as the text isn't modified.
+	class StyledText {
+	public:
+		using attributes_t = StyledString::attributes_t;
+
+		// A string in the text, given by its position in the buffer.
+		struct run {
+			std::size_t offset;
+			std::size_t size;
+			attributes_t attributes;
+		};
+
+		class const_iterator {
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = StyledStringView;
+			using difference_type = std::ptrdiff_t;
+			using pointer = void;
+			using reference = StyledStringView;
+
+			const_iterator() = default;
+
+			StyledStringView operator*() const {
+				return {_chars.substr(_run->offset, _run->size), _run->attributes};
+			}
+
+			const_iterator & operator++() {
+				++_run;
+				return *this;
+			}
+
+			const_iterator operator++(int) {
+				auto copy = *this;
+				++_run;
+				return copy;
+			}
+
+			bool operator==(const const_iterator & other) const {
+				return _run == other._run;
+			}
+
+		private:
+			friend class StyledText;
+
+			const_iterator(string_view chars, vector<run>::const_iterator run)
+			: _chars{chars}, _run{run} { }
+
+			string_view _chars{};
+			vector<run>::const_iterator _run{};
+		};
+
+		StyledText() = default;
+
+		// Create a text from a buffer and the runs marking out each of its
+		// strings.
+		StyledText(string buffer, vector<run> runs)
+		: _buffer{move(buffer)}, _runs{move(runs)} { }
+
+		// Add `str` to the end of the text, with the given attributes. Does
+		// nothing if `str` is empty.
+		void append(string_view str, attributes_t attributes) {
+			if (str.empty()) return;
+			_runs.push_back({_buffer.size(), str.size(), attributes});
+			_buffer += str;
+		}
+
+		void clear() {
+			_buffer.clear();
+			_runs.clear();
+		}
+
+		// The number of strings in the text.
+		std::size_t size() const { return _runs.size(); }
+
+		bool empty() const { return _runs.empty(); }
+
+		// The characters of every string in the text, one after another.
+		string_view chars() const { return _buffer; }
+
+		span<const run> runs() const { return _runs; }
+
+		StyledStringView operator[](std::size_t i) const {
+			auto& r = _runs[i];
+			return {chars().substr(r.offset, r.size), r.attributes};
+		}
+
+		const_iterator begin() const { return {chars(), _runs.begin()}; }
+		const_iterator end() const { return {chars(), _runs.end()}; }
+
+	private:
+		string _buffer{};
+		vector<run> _runs{};
+	};
 
 	// Type for exceptions that can be thrown when calling `format_text`.
 	struct format_text_error {
@@ -220,7 +626,7 @@ namespace maf {
 		index pos() const;
 
 		format_text_error(error_code code, string_view substr):
-			param{substr}
+			code{code}, param{substr}
 		{}
 
 		// Get a description of the error.
@@ -244,6 +650,77 @@ namespace maf {
 	// code for more information.
 	StyledText format_text(string_view input,
 		StyledString::attributes_t attributes = StyledString::default_attributes);
+
+	// A sink which formats text as it's written, in the same way as
+	// `format_text`, so that a template can be turned into styled text in a
+	// single pass without first being written out to a string.
+	class StyledTextWriter: public TextSink {
+	public:
+		explicit StyledTextWriter(
+			StyledString::attributes_t attributes = StyledString::default_attributes)
+		: _attributes{attributes} { }
+
+		// Format `chunk` and add it to the end of the text.
+		//
+		// # Exceptions
+		// Throws `format_text_error` if `chunk` contains an invalid escape
+		// sequence. The error refers to `chunk` alone, so use `format_text`
+		// on the whole text to find where the error occurred.
+		void write(string_view chunk) override;
+
+		// Remove any whitespace after the last formatting code or escape
+		// sequence from the end of the text. This has the same effect as
+		// dropping whitespace from the end of the input to `format_text`.
+		void drop_whitespace_from_end();
+
+		// Take the text written so far, leaving the writer empty.
+		//
+		// # Exceptions
+		// Throws `format_text_error` if the text ends part of the way
+		// through an escape sequence.
+		StyledText finish();
+
+	private:
+		string _buffer{};
+		vector<StyledText::run> _runs{};
+		StyledString::attributes_t _attributes;
+		// The start of the block that hasn't been added to `_runs` yet.
+		std::size_t _block_begin{0};
+		// The end of the last formatting code or escape sequence.
+		std::size_t _hard_end{0};
+		// Whether the last chunk ended with the start of an escape sequence.
+		bool _in_escape{false};
+
+		void _end_block();
+	};
+
+	// Split `text` into segments, each of which ends either after a newline
+	// or at the end of one of the text's runs. Segments are views into
+	// `text`.
+	vector<StyledStringView> segments(const StyledText & text);
+
+	// A change made to the segments of a `StyledText`, replacing
+	// `num_removed` segments starting at `position` with `inserted`. An
+	// insertion removes nothing, and a deletion inserts nothing.
+	struct StyledTextEdit {
+		// The position of the first segment removed, or of the segment
+		// which the insertion comes before, in the old text.
+		std::size_t position;
+		// The number of segments removed.
+		std::size_t num_removed;
+		// The segments inserted, which are views into the new text.
+		vector<StyledStringView> inserted;
+	};
+
+	// Find a short list of edits turning the segments of `old_text` into
+	// the segments of `new_text`, sorted by position.
+	//
+	// Unchanged lines are never resent, so the size of the edits depends
+	// on how much of the text has changed rather than on its length. If
+	// the texts are very long and very different, a single edit replacing
+	// every changed segment may be returned instead.
+	vector<StyledTextEdit> diff(const StyledText & old_text,
+		const StyledText & new_text);
 }
 
 #endif
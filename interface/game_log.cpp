@@ -22,6 +22,12 @@ namespace maf {
 			throw Players_to_cards_mismatch{player_names.size(), role_ids.size() + wildcard_ids.size()};
 		}
 
+		for (const core::Player & player: players()) {
+			_player_ids.emplace(get_name(player), player.id());
+			_player_matcher.add(get_name(player));
+			_player_trie.add(get_name(player));
+		}
+
 		if (!game().random_roles().empty()) {
 			_append_screen<Wildcards_resolved>();
 		}
@@ -67,57 +73,64 @@ namespace maf {
 		}
 	}
 
-	void Game_log::do_commands(const vector<string_view> & commands) {
+	void Game_log::do_commands(const CmdSequence & commands) {
 		_screen_stack[_screen_stack_idx]->do_commands(commands);
 	}
 
-	void Game_log::write_transcript(string & output) const {
+	void Game_log::write_transcript(TextSink & output) const {
+		// Only one summary is held in memory at a time. It's written out in
+		// full before being passed on, so that it can be replaced by an
+		// error if it can't be preprocessed.
+		string raw_text;
+		string summary;
+
 		for (auto& event: _screen_stack) {
-			string raw_text;
+			raw_text.clear();
 			event->summarise(raw_text);
 
 			if (!raw_text.empty()) {
 				TextParams params;
 				event->set_params(params);
 
-				try {
-					auto summary = preprocess_text(raw_text, params);
+				summary.clear();
 
-					if (!summary.empty()) {
-						output += summary;
-						char last_char = summary.back();
-						if (last_char != '\n') output += '\n';
-					}
+				try {
+					StringSink sink{summary};
+					preprocess_text(raw_text, params, sink);
 				} catch (preprocess_text_error & error) {
-					output += "ERROR: Unable to summarise \"";
-					output += escaped(event->id());
-					output += "\".\n";
+					summary.clear();
+					summary += "ERROR: Unable to summarise \"";
+					summary += escaped(event->id());
+					summary += "\".";
+				}
+
+				if (!summary.empty()) {
+					output.write(summary);
+					if (summary.back() != '\n') output.write("\n");
 				}
 			}
 		}
 	}
 
 	const core::Player & Game_log::find_player(core::Player::ID id) const {
-		for (const core::Player & player: players()) {
-			if (id == player.id()) return player;
-		}
+		// Players are stored in order of ID.
+		auto players = this->players();
+		auto index = static_cast<std::size_t>(id);
+		if (index < players.size()) return players[index];
 
 		/* FIXME: throw exception in Game_log namespace, or remove this function. */
 		throw core::Game::Player_not_found{id};
 	}
 
 	const core::Player & Game_log::find_player(string_view name) const {
-		auto names_match = [&](const core::Player & player) -> bool {
-			return util::equal_up_to_case(name, this->get_name(player));
-		};
+		auto iter = _player_ids.find(name);
 
-		auto players = this->players();
-		auto iter = util::find_if(players, names_match);
-
-		if (iter == players.end())
-			throw Player_not_found{string{name}};
+		if (iter == _player_ids.end()) {
+			auto suggestions = _player_matcher.closest(name);
+			throw Player_not_found{string{name}, {suggestions.begin(), suggestions.end()}};
+		}
 
-		return *iter;
+		return find_player(iter->second);
 	}
 
 	string_view Game_log::get_name(const core::Player & player) const {
@@ -130,6 +143,7 @@ namespace maf {
 
 	void Game_log::kick_player(core::Player::ID id) {
 		_game.kick_player(id);
+		_player_trie.remove(get_name(id));
 		const core::Player & player = find_player(id);
 		_append_screen<Player_kicked>(player);
 
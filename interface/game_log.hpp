@@ -10,9 +10,13 @@
 
 #include "../core/core.hpp"
 
+#include "command.hpp"
+#include "names.hpp"
+
 namespace maf {
 	class Console;
 	class Game_screen;
+	class TextSink;
 
 	class Game_log {
 	public:
@@ -26,6 +30,8 @@ namespace maf {
 		// Signifies that no player could be found with the given name.
 		struct Player_not_found {
 			string name;
+			// The names of some players with similar names, closest first.
+			vector<string> suggestions{};
 		};
 
 		// An exception signifying that an ability use has not been programmed in
@@ -67,11 +73,12 @@ namespace maf {
 
 		// Handles the given commands, by passing them to the active screen.
 		// Throws an exception if the commands couldn't be handled.
-		void do_commands(const vector<string_view> & commands);
+		void do_commands(const CmdSequence & commands);
 
-		// Writes a transcript to `str`, containing a summary of every event
-		// that has occurred so far, in chronological order.
-		void write_transcript(string & str) const;
+		// Writes a transcript to `output`, containing a summary of every
+		// event that has occurred so far, in chronological order. Each
+		// summary is passed on to `output` as soon as it's been written.
+		void write_transcript(TextSink & output) const;
 
 		// Finds the player with the given ID.
 		// Throws an exception if no such player could be found.
@@ -87,6 +94,10 @@ namespace maf {
 		/// Get the name of the player with the given ID.
 		string_view get_name(core::Player::ID id) const;
 
+		/// The names of the players who haven't been kicked from the game,
+		/// for completing names as they're typed.
+		const Name_trie & player_trie() const { return _player_trie; }
+
 		void kick_player(core::Player::ID id);
 
 		void cast_lynch_vote(core::Player::ID voter_id, core::Player::ID target_id);
@@ -118,6 +129,14 @@ namespace maf {
 		core::Game _game;
 
 		vector<string> _player_names;
+		// The ID of each player, found by name up to case. The keys are
+		// views into `_player_names`, which never changes.
+		Name_index<core::Player::ID> _player_ids{};
+		// Used to suggest names when a player can't be found.
+		Name_matcher _player_matcher{};
+		// Used to complete the names of players who are still in the game
+		// as they're typed.
+		Name_trie _player_trie{};
 
 		vector<unique_ptr<Game_screen>> _screen_stack{};
 		index _screen_stack_idx{0};
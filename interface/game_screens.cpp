@@ -1,10 +1,10 @@
-#include "../util/fstream.hpp"
 #include "../util/misc.hpp"
 
 #include "command.hpp"
 #include "console.hpp"
 #include "game_screens.hpp"
 #include "names.hpp"
+#include "resources.hpp"
 
 namespace maf {
 	const core::Game & Game_screen::game() const {
@@ -19,26 +19,33 @@ namespace maf {
 		return console().game_log();
 	}
 
+	const CmdRouter<Game_screen> Game_screen::_router{
+		{{"help"}, [](Game_screen & screen, const CmdSequence &) {
+			screen.console().show_help_screen<Game_help_screen>(screen);
+		}},
+		{{"end"}, [](Game_screen & screen, const CmdSequence &) {
+			screen.console().show_question<Confirm_end_game>();
+		}},
+	};
+
 	void Game_screen::do_commands(const CmdSequence & commands) {
-		if (commands_match(commands, {"help"})) {
-			console().show_help_screen<Game_help_screen>(*this);
-		} else if (commands_match(commands, {"end"})) {
-			console().show_question<Confirm_end_game>();
-		} else {
+		if (!_router.dispatch(*this, commands)) {
 			Screen::do_commands(commands);
 		}
 	}
 
+	void Game_screen::list_commands(vector<CmdPattern> & patterns) const {
+		_router.list(*this, patterns);
+		Screen::list_commands(patterns);
+	}
+
 	void Game_screen::summarise(string & output) const {
-		auto path = application::root_dir();
-		path /= "resources";
-		path /= "txt";
-		path /= "events";
+		fs::path path = "txt/events";
 		path /= this->id();
 		path += ".txt";
 
-		if (ifstream input{path}; input) {
-			output += util::read_all(input);
+		if (auto resource = resources::load(path)) {
+			output += resource->str();
 		}
 	}
 
@@ -50,15 +57,28 @@ namespace maf {
 		return escaped(full_name(role));
 	}
 
+	std::uint64_t Game_screen::_version_with(std::uint64_t local) const {
+		return (game().version() << 16) | local;
+	}
+
+	const CmdRouter<Player_given_initial_role> Player_given_initial_role::_router{
+		{{"ok"}, [](Player_given_initial_role & screen, const CmdSequence &) {
+			if (screen._is_private) screen.game_log().advance();
+			else screen._is_private = true;
+		}},
+	};
+
 	void Player_given_initial_role::do_commands(const CmdSequence & commands) {
-		if (commands_match(commands, {"ok"})) {
-			if (_is_private) game_log().advance();
-			else _is_private = true;
-		} else {
+		if (!_router.dispatch(*this, commands)) {
 			Game_screen::do_commands(commands);
 		}
 	}
 
+	void Player_given_initial_role::list_commands(vector<CmdPattern> & patterns) const {
+		_router.list(*this, patterns);
+		Game_screen::list_commands(patterns);
+	}
+
 	void Player_given_initial_role::set_params(TextParams & params) const {
 		params["player"] = escaped_name(*_player);
 		params["private"] = _is_private;
@@ -66,14 +86,23 @@ namespace maf {
 		params["role.alias"] = escaped(_role->alias());
 	}
 
+	const CmdRouter<Wildcards_resolved> Wildcards_resolved::_router{
+		{{"ok"}, [](Wildcards_resolved & screen, const CmdSequence &) {
+			screen.game_log().advance();
+		}},
+	};
+
 	void Wildcards_resolved::do_commands(const CmdSequence & commands) {
-		if (commands_match(commands, {"ok"})) {
-			game_log().advance();
-		} else {
+		if (!_router.dispatch(*this, commands)) {
 			Game_screen::do_commands(commands);
 		}
 	}
 
+	void Wildcards_resolved::list_commands(vector<CmdPattern> & patterns) const {
+		_router.list(*this, patterns);
+		Game_screen::list_commands(patterns);
+	}
+
 	void maf::Wildcards_resolved::set_params(TextParams & params) const {
 		std::map<not_null<const core::Role *>, int> cards;
 
@@ -85,44 +114,65 @@ namespace maf {
 			}
 		}
 
-		params["cards"] = util::transform_into<vector<TextParams>>(cards, [&](auto& elem) -> TextParams {
-			TextParams params{};
-			params["role"] = escaped_name(*(elem.first));
-			params["count"] = elem.second;
-			return params;
+		params.provide("cards", [this, cards = move(cards)](TextParam & param) {
+			TextParamsList cards_params{param.get_allocator()};
+
+			for (auto& [role, count]: cards) {
+				auto& subparams = cards_params.emplace_back();
+				subparams["role"] = escaped_name(*role);
+				subparams["count"] = count;
+			}
+
+			param = move(cards_params);
 		});
 	}
 
+	const CmdRouter<Time_changed> Time_changed::_router{
+		{{"ok"}, [](Time_changed & screen, const CmdSequence &) {
+			screen.game_log().advance();
+		}},
+	};
+
 	void maf::Time_changed::do_commands(const CmdSequence & commands) {
-		if (commands_match(commands, {"ok"})) {
-			game_log().advance();
-		} else {
+		if (!_router.dispatch(*this, commands)) {
 			Game_screen::do_commands(commands);
 		}
 	}
 
+	void maf::Time_changed::list_commands(vector<CmdPattern> & patterns) const {
+		_router.list(*this, patterns);
+		Game_screen::list_commands(patterns);
+	}
+
 	void maf::Time_changed::set_params(TextParams & params) const {
 		params["date"] = static_cast<int>(date);
 		params["daytime"] = (time == core::Time::day);
 		params["nighttime"] = (time == core::Time::night);
 	}
 
-	void maf::Obituary::do_commands(const CmdSequence & commands) {
-		if (commands_match(commands, {"ok"})) {
-			if (_deaths_index + 1 < _deaths.size()) {
-				++_deaths_index;
+	const CmdRouter<Obituary> Obituary::_router{
+		{{"ok"}, [](Obituary & screen, const CmdSequence &) {
+			if (screen._deaths_index + 1 < screen._deaths.size()) {
+				++screen._deaths_index;
 			} else {
-				game_log().advance();
+				screen.game_log().advance();
 			}
-		} else {
+		}},
+	};
+
+	void maf::Obituary::do_commands(const CmdSequence & commands) {
+		if (!_router.dispatch(*this, commands)) {
 			Game_screen::do_commands(commands);
 		}
 	}
 
-	maf::TextParams maf::Obituary::_get_params(const core::Player & player) const {
-		TextParams params;
+	void maf::Obituary::list_commands(vector<CmdPattern> & patterns) const {
+		_router.list(*this, patterns);
+		Game_screen::list_commands(patterns);
+	}
+
+	void maf::Obituary::_set_params(TextParams & params, const core::Player & player) const {
 		params["deceased"] = escaped_name(player);
-		return params;
 	}
 
 	void maf::Obituary::set_params(TextParams& params) const {
@@ -143,64 +193,57 @@ namespace maf {
 			}
 		}
 
-		params["deaths"] = util::transformed_copy(_deaths, [&](const core::Player & player) {
-			return this->_get_params(player);
-		});
-	}
+		params["deaths"] = TextParamsGenerator{_deaths.size(),
+			[this](std::size_t i, TextParams & item) {
+				this->_set_params(item, _deaths[i]);
+			}};
+	}
+
+	const CmdRouter<Town_meeting> Town_meeting::_router{
+		{{CmdSlot::player, "vote", CmdSlot::player}, [](Town_meeting & screen, const CmdSequence & commands) {
+			auto& voter  = screen.game_log().find_player(commands[0]);
+			auto& target = screen.game_log().find_player(commands[2]);
+			screen.game_log().cast_lynch_vote(voter.id(), target.id());
+			screen.game_log().advance();
+		}, [](const Town_meeting & screen) { return screen._lynch_can_occur; }},
+		{{CmdSlot::player, "abstain"}, [](Town_meeting & screen, const CmdSequence & commands) {
+			auto& voter = screen.game_log().find_player(commands[0]);
+			screen.game_log().clear_lynch_vote(voter.id());
+			screen.game_log().advance();
+		}, [](const Town_meeting & screen) { return screen._lynch_can_occur; }},
+		{{"lynch"}, [](Town_meeting & screen, const CmdSequence &) {
+			screen.game_log().process_lynch_votes();
+			screen.game_log().advance();
+		}, [](const Town_meeting & screen) { return screen._lynch_can_occur; }},
+		{{"night"}, [](Town_meeting & screen, const CmdSequence &) {
+			screen.game_log().begin_night();
+			screen.game_log().advance();
+		}, [](const Town_meeting & screen) { return !screen._lynch_can_occur; }},
+		{{"kick", CmdSlot::player}, [](Town_meeting & screen, const CmdSequence & commands) {
+			auto& player = screen.game_log().find_player(commands[1]);
+			screen.game_log().kick_player(player.id());
+			screen.game_log().advance();
+		}},
+		{{CmdSlot::player, "duel", CmdSlot::player}, [](Town_meeting & screen, const CmdSequence & commands) {
+			auto& caster = screen.game_log().find_player(commands[0]);
+			auto& target = screen.game_log().find_player(commands[2]);
+			screen.game_log().stage_duel(caster.id(), target.id());
+			screen.game_log().advance();
+		}},
+	};
 
 	void maf::Town_meeting::do_commands(const CmdSequence & commands) {
-		if (_lynch_can_occur) {
-			_do_commands_before_lynch(commands);
-		} else {
-			_do_commands_after_lynch(commands);
-		}
-	}
-
-	void maf::Town_meeting::_do_commands_before_lynch(const CmdSequence & commands) {
-		if (commands_match(commands, {"", "vote", ""})) {
-			auto& voter  = game_log().find_player(commands[0]);
-			auto& target = game_log().find_player(commands[2]);
-			game_log().cast_lynch_vote(voter.id(), target.id());
-			game_log().advance();
-		} else if (commands_match(commands, {"", "abstain"})) {
-			auto& voter = game_log().find_player(commands[0]);
-			game_log().clear_lynch_vote(voter.id());
-			game_log().advance();
-		} else if (commands_match(commands, {"lynch"})) {
-			game_log().process_lynch_votes();
-			game_log().advance();
-		} else {
-			_do_other_commands(commands);
-		}
-	}
-
-	void maf::Town_meeting::_do_commands_after_lynch(const CmdSequence & commands) {
-		if (commands_match(commands, {"night"})) {
-			game_log().begin_night();
-			game_log().advance();
-		} else {
-			_do_other_commands(commands);
-		}
-	}
-
-	void maf::Town_meeting::_do_other_commands(const CmdSequence & commands) {
-		if (commands_match(commands, {"kick", ""})) {
-			auto& player = game_log().find_player(commands[1]);
-			game_log().kick_player(player.id());
-			game_log().advance();
-		} else if (commands_match(commands, {"", "duel", ""})) {
-			auto& caster = game_log().find_player(commands[0]);
-			auto& target = game_log().find_player(commands[2]);
-			game_log().stage_duel(caster.id(), target.id());
-			game_log().advance();
-		} else {
+		if (!_router.dispatch(*this, commands)) {
 			Game_screen::do_commands(commands);
 		}
 	}
 
-	maf::TextParams maf::Town_meeting::_get_params(const core::Player & player) const {
-		TextParams params;
+	void maf::Town_meeting::list_commands(vector<CmdPattern> & patterns) const {
+		_router.list(*this, patterns);
+		Game_screen::list_commands(patterns);
+	}
 
+	void maf::Town_meeting::_set_params(TextParams & params, const core::Player & player) const {
 		params["player"] = escaped_name(player);
 
 		if (_lynch_can_occur) {
@@ -213,8 +256,6 @@ namespace maf {
 				params["player.has_voted"] = false;
 			}
 		}
-
-		return params;
 	}
 
 	void maf::Town_meeting::set_params(TextParams & params) const {
@@ -241,32 +282,51 @@ namespace maf {
 			}
 		}
 
-		params["townsfolk"] = util::transformed_copy(_players, [&](const core::Player & player) {
-			return this->_get_params(player);
-		});
+		params["townsfolk"] = TextParamsGenerator{_players.size(),
+			[this](std::size_t i, TextParams & item) {
+				this->_set_params(item, _players[i]);
+			}};
 	}
 
+	const CmdRouter<Player_kicked> Player_kicked::_router{
+		{{"ok"}, [](Player_kicked & screen, const CmdSequence &) {
+			screen.game_log().advance();
+		}},
+	};
+
 	void maf::Player_kicked::do_commands(const CmdSequence & commands) {
-		if (commands_match(commands, {"ok"})) {
-			game_log().advance();
-		} else {
+		if (!_router.dispatch(*this, commands)) {
 			Game_screen::do_commands(commands);
 		}
 	}
 
+	void maf::Player_kicked::list_commands(vector<CmdPattern> & patterns) const {
+		_router.list(*this, patterns);
+		Game_screen::list_commands(patterns);
+	}
+
 	void maf::Player_kicked::set_params(TextParams & params) const {
 		params["player"] = escaped_name(_player);
 		params["role"] = escaped_name(_player.role());
 	}
 
+	const CmdRouter<Lynch_result> Lynch_result::_router{
+		{{"ok"}, [](Lynch_result & screen, const CmdSequence &) {
+			screen.game_log().advance();
+		}},
+	};
+
 	void maf::Lynch_result::do_commands(const CmdSequence & commands) {
-		if (commands_match(commands, {"ok"})) {
-			game_log().advance();
-		} else {
+		if (!_router.dispatch(*this, commands)) {
 			Game_screen::do_commands(commands);
 		}
 	}
 
+	void maf::Lynch_result::list_commands(vector<CmdPattern> & patterns) const {
+		_router.list(*this, patterns);
+		Game_screen::list_commands(patterns);
+	}
+
 	void maf::Lynch_result::set_params(TextParams & params) const {
 		params["victim.exists"] = (victim != nullptr);
 
@@ -283,14 +343,23 @@ namespace maf {
 		}
 	}
 
+	const CmdRouter<Duel_result> Duel_result::_router{
+		{{"ok"}, [](Duel_result & screen, const CmdSequence &) {
+			screen.game_log().advance();
+		}},
+	};
+
 	void maf::Duel_result::do_commands(const CmdSequence & commands) {
-		if (commands_match(commands, {"ok"})) {
-			game_log().advance();
-		} else {
+		if (!_router.dispatch(*this, commands)) {
 			Game_screen::do_commands(commands);
 		}
 	}
 
+	void maf::Duel_result::list_commands(vector<CmdPattern> & patterns) const {
+		_router.list(*this, patterns);
+		Game_screen::list_commands(patterns);
+	}
+
 	void maf::Duel_result::set_params(TextParams & params) const {
 		params["caster"] = escaped_name(caster);
 		params["caster.won_duel"] = (caster == target);
@@ -300,24 +369,35 @@ namespace maf {
 		params["winner.fled"] = !(winner.is_present());
 	}
 
-	void maf::Choose_fake_role::do_commands(const CmdSequence & commands) {
-		if (_finished && commands_match(commands, {"ok"})) {
-			game_log().advance();
-		} else if (_fake_role && commands_match(commands, {"ok"})) {
-			_finished = true;
-		} else if (commands_match(commands, {"choose", ""})) {
+	const CmdRouter<Choose_fake_role> Choose_fake_role::_router{
+		{{"ok"}, [](Choose_fake_role & screen, const CmdSequence &) {
+			screen.game_log().advance();
+		}, [](const Choose_fake_role & screen) { return screen._finished; }},
+		{{"ok"}, [](Choose_fake_role & screen, const CmdSequence &) {
+			screen._finished = true;
+		}, [](const Choose_fake_role & screen) { return screen._fake_role != nullptr; }},
+		{{"choose", CmdSlot::role}, [](Choose_fake_role & screen, const CmdSequence & commands) {
 			try {
-				const core::Role & fake_role = game_log().look_up(commands[1]);
-				game_log().choose_fake_role(_player->id(), fake_role.id());
-				_fake_role = _player->fake_role();
+				const core::Role & fake_role = screen.game_log().look_up(commands[1]);
+				screen.game_log().choose_fake_role(screen._player->id(), fake_role.id());
+				screen._fake_role = screen._player->fake_role();
 			} catch (std::out_of_range const&) {
 				throw core::Rulebook::Missing_role_alias{string{commands[1]}};
 			}
-		} else {
+		}},
+	};
+
+	void maf::Choose_fake_role::do_commands(const CmdSequence & commands) {
+		if (!_router.dispatch(*this, commands)) {
 			Game_screen::do_commands(commands);
 		}
 	}
 
+	void maf::Choose_fake_role::list_commands(vector<CmdPattern> & patterns) const {
+		_router.list(*this, patterns);
+		Game_screen::list_commands(patterns);
+	}
+
 	void maf::Choose_fake_role::set_params(TextParams & params) const {
 		params["finished"] = _finished;
 		params["player"] = escaped_name(*_player);
@@ -331,43 +411,39 @@ namespace maf {
 		}
 	}
 
-	void maf::Mafia_meeting::do_commands(const CmdSequence & commands) {
-		if (_first_meeting) {
-			_do_commands_for_first_meeting(commands);
-		} else {
-			_do_commands_for_regular_meeting(commands);
-		}
-	}
+	const CmdRouter<Mafia_meeting> Mafia_meeting::_router{
+		{{"ok"}, [](Mafia_meeting & screen, const CmdSequence &) {
+			if (screen._finished) screen.game_log().advance();
+			else screen._finished = true;
+		}, [](const Mafia_meeting & screen) { return screen._first_meeting || screen._finished; }},
+		{{"kill", CmdSlot::player}, [](Mafia_meeting & screen, const CmdSequence & commands) {
+			auto& caster = screen._mafiosi.front().get();
+			auto& target = screen.game_log().find_player(commands[1]);
+			screen.game_log().cast_mafia_kill(caster.id(), target.id());
+			screen._finished = true;
+		}, [](const Mafia_meeting & screen) { return screen._can_kill() && screen._mafiosi.size() == 1; }},
+		{{CmdSlot::player, "kill", CmdSlot::player}, [](Mafia_meeting & screen, const CmdSequence & commands) {
+			auto& caster = screen.game_log().find_player(commands[0]);
+			auto& target = screen.game_log().find_player(commands[2]);
+			screen.game_log().cast_mafia_kill(caster.id(), target.id());
+			screen._finished = true;
+		}, [](const Mafia_meeting & screen) { return screen._can_kill() && screen._mafiosi.size() > 1; }},
+		{{"skip"}, [](Mafia_meeting & screen, const CmdSequence &) {
+			// TODO: Show "confirm skip?" screen.
+			screen.game_log().skip_mafia_kill();
+			screen._finished = true;
+		}, [](const Mafia_meeting & screen) { return screen._can_kill(); }},
+	};
 
-	void maf::Mafia_meeting::_do_commands_for_first_meeting(const CmdSequence & commands) {
-		if (commands_match(commands, {"ok"})) {
-			if (_finished) game_log().advance();
-			else _finished = true;
-		} else {
+	void maf::Mafia_meeting::do_commands(const CmdSequence & commands) {
+		if (!_router.dispatch(*this, commands)) {
 			Game_screen::do_commands(commands);
 		}
 	}
 
-	void maf::Mafia_meeting::_do_commands_for_regular_meeting(const CmdSequence & commands) {
-		if (_finished && commands_match(commands, {"ok"})) {
-			game_log().advance();
-		} else if (_mafiosi.size() == 1 && commands_match(commands, {"kill", ""})) {
-			auto& caster = _mafiosi.front().get();
-			auto& target = game_log().find_player(commands[1]);
-			game_log().cast_mafia_kill(caster.id(), target.id());
-			_finished = true;
-		} else if (_mafiosi.size() > 1 && commands_match(commands, {"", "kill", ""})) {
-			auto& caster = game_log().find_player(commands[0]);
-			auto& target = game_log().find_player(commands[2]);
-			game_log().cast_mafia_kill(caster.id(), target.id());
-			_finished = true;
-		} else if (commands_match(commands, {"skip"})) {
-			// TODO: Show "confirm skip?" screen.
-			game_log().skip_mafia_kill();
-			_finished = true;
-		} else {
-			Game_screen::do_commands(commands);
-		}
+	void maf::Mafia_meeting::list_commands(vector<CmdPattern> & patterns) const {
+		_router.list(*this, patterns);
+		Game_screen::list_commands(patterns);
 	}
 
 	void maf::Mafia_meeting::set_params(TextParams& params) const {
@@ -380,118 +456,179 @@ namespace maf {
 			params["role"] = escaped_name(player.role());
 			params["mafia.size"] = 1;
 		} else {
-			vector<TextParams> mafia;
-			for (const core::Player & player: _mafiosi) {
-				auto& subparams = mafia.emplace_back();
-				subparams["player"] = escaped_name(player);
-				subparams["role"] = escaped_name(player.role());
-			}
-			params["mafia.size"] = static_cast<int>(mafia.size());
-			params["mafia"] = move(mafia);
-		}
-	}
+			params["mafia.size"] = static_cast<int>(_mafiosi.size());
+			params["mafia"] = TextParamsGenerator{_mafiosi.size(),
+				[this](std::size_t i, TextParams & item) {
+					const core::Player & player = _mafiosi[i];
+					item["player"] = escaped_name(player);
+					item["role"] = escaped_name(player.role());
+				}};
+		}
+	}
+
+	const CmdRouter<Kill_use> Kill_use::_router{
+		{{"ok"}, [](Kill_use & screen, const CmdSequence &) {
+			screen.game_log().advance();
+		}, [](const Kill_use & screen) { return screen._finished; }},
+		{{"kill", CmdSlot::player}, [](Kill_use & screen, const CmdSequence & commands) {
+			auto& target = screen.game_log().find_player(commands[1]);
+			screen.game_log().cast_kill(screen._caster.id(), target.id());
+			screen._finished = true;
+		}, [](const Kill_use & screen) { return !screen._finished; }},
+		{{"skip"}, [](Kill_use & screen, const CmdSequence &) {
+			screen.game_log().skip_kill(screen._caster.id());
+			screen._finished = true;
+		}, [](const Kill_use & screen) { return !screen._finished; }},
+	};
 
 	void maf::Kill_use::do_commands(const CmdSequence & commands) {
-		if (_finished && commands_match(commands, {"ok"})) {
-			game_log().advance();
-		} else if (!_finished && commands_match(commands, {"kill", ""})) {
-			auto& target = game_log().find_player(commands[1]);
-			game_log().cast_kill(_caster.id(), target.id());
-			_finished = true;
-		} else if (!_finished && commands_match(commands, {"skip"})) {
-			game_log().skip_kill(_caster.id());
-			_finished = true;
-		} else {
+		if (!_router.dispatch(*this, commands)) {
 			Game_screen::do_commands(commands);
 		}
 	}
 
+	void maf::Kill_use::list_commands(vector<CmdPattern> & patterns) const {
+		_router.list(*this, patterns);
+		Game_screen::list_commands(patterns);
+	}
+
 	void maf::Kill_use::set_params(TextParams& params) const {
 		params["caster"] = escaped_name(_caster);
 		params["finished"] = _finished;
 	}
 
+	const CmdRouter<Heal_use> Heal_use::_router{
+		{{"ok"}, [](Heal_use & screen, const CmdSequence &) {
+			screen.game_log().advance();
+		}, [](const Heal_use & screen) { return screen._finished; }},
+		{{"heal", CmdSlot::player}, [](Heal_use & screen, const CmdSequence & commands) {
+			auto& target = screen.game_log().find_player(commands[1]);
+			screen.game_log().cast_heal(screen._caster.id(), target.id());
+			screen._finished = true;
+		}, [](const Heal_use & screen) { return !screen._finished; }},
+		{{"skip"}, [](Heal_use & screen, const CmdSequence &) {
+			screen.game_log().skip_heal(screen._caster.id());
+			screen._finished = true;
+		}, [](const Heal_use & screen) { return !screen._finished; }},
+	};
+
 	void maf::Heal_use::do_commands(const CmdSequence & commands) {
-		if (_finished && commands_match(commands, {"ok"})) {
-			game_log().advance();
-		} else if (!_finished && commands_match(commands, {"heal", ""})) {
-			auto& target = game_log().find_player(commands[1]);
-			game_log().cast_heal(_caster.id(), target.id());
-			_finished = true;
-		} else if (!_finished && commands_match(commands, {"skip"})) {
-			game_log().skip_heal(_caster.id());
-			_finished = true;
-		} else {
+		if (!_router.dispatch(*this, commands)) {
 			Game_screen::do_commands(commands);
 		}
 	}
 
+	void maf::Heal_use::list_commands(vector<CmdPattern> & patterns) const {
+		_router.list(*this, patterns);
+		Game_screen::list_commands(patterns);
+	}
+
 	void maf::Heal_use::set_params(TextParams& params) const {
 		params["caster"] = escaped_name(_caster);
 		params["finished"] = _finished;
 	}
 
+	const CmdRouter<Investigate_use> Investigate_use::_router{
+		{{"ok"}, [](Investigate_use & screen, const CmdSequence &) {
+			screen.game_log().advance();
+		}, [](const Investigate_use & screen) { return screen._finished; }},
+		{{"check", CmdSlot::player}, [](Investigate_use & screen, const CmdSequence & commands) {
+			auto& target = screen.game_log().find_player(commands[1]);
+			screen.game_log().cast_investigate(screen._caster.id(), target.id());
+			screen._finished = true;
+		}, [](const Investigate_use & screen) { return !screen._finished; }},
+		{{"skip"}, [](Investigate_use & screen, const CmdSequence &) {
+			screen.game_log().skip_investigate(screen._caster.id());
+			screen._finished = true;
+		}, [](const Investigate_use & screen) { return !screen._finished; }},
+	};
+
 	void maf::Investigate_use::do_commands(const CmdSequence & commands) {
-		if (_finished && commands_match(commands, {"ok"})) {
-			game_log().advance();
-		} else if (!_finished && commands_match(commands, {"check", ""})) {
-			auto& target = game_log().find_player(commands[1]);
-			game_log().cast_investigate(_caster.id(), target.id());
-			_finished = true;
-		} else if (!_finished && commands_match(commands, {"skip"})) {
-			game_log().skip_investigate(_caster.id());
-			_finished = true;
-		} else {
+		if (!_router.dispatch(*this, commands)) {
 			Game_screen::do_commands(commands);
 		}
 	}
 
+	void maf::Investigate_use::list_commands(vector<CmdPattern> & patterns) const {
+		_router.list(*this, patterns);
+		Game_screen::list_commands(patterns);
+	}
+
 	void maf::Investigate_use::set_params(TextParams & params) const {
 		params["caster"] = escaped_name(_caster);
 		params["finished"] = _finished;
 	}
 
+	const CmdRouter<Peddle_use> Peddle_use::_router{
+		{{"ok"}, [](Peddle_use & screen, const CmdSequence &) {
+			screen.game_log().advance();
+		}, [](const Peddle_use & screen) { return screen._finished; }},
+		{{"target", CmdSlot::player}, [](Peddle_use & screen, const CmdSequence & commands) {
+			auto& target = screen.game_log().find_player(commands[1]);
+			screen.game_log().cast_peddle(screen._caster.id(), target.id());
+			screen._finished = true;
+		}, [](const Peddle_use & screen) { return !screen._finished; }},
+		{{"skip"}, [](Peddle_use & screen, const CmdSequence &) {
+			screen.game_log().skip_peddle(screen._caster.id());
+			screen._finished = true;
+		}, [](const Peddle_use & screen) { return !screen._finished; }},
+	};
+
 	void maf::Peddle_use::do_commands(const CmdSequence & commands) {
-		if (_finished && commands_match(commands, {"ok"})) {
-			game_log().advance();
-		} else if (!_finished && commands_match(commands, {"target", ""})) {
-			auto& target = game_log().find_player(commands[1]);
-			game_log().cast_peddle(_caster.id(), target.id());
-			_finished = true;
-		} else if (!_finished && commands_match(commands, {"skip"})) {
-			game_log().skip_peddle(_caster.id());
-			_finished = true;
-		} else {
+		if (!_router.dispatch(*this, commands)) {
 			Game_screen::do_commands(commands);
 		}
 	}
 
+	void maf::Peddle_use::list_commands(vector<CmdPattern> & patterns) const {
+		_router.list(*this, patterns);
+		Game_screen::list_commands(patterns);
+	}
+
 	void maf::Peddle_use::set_params(TextParams& params) const {
 		params["caster"] = escaped_name(_caster);
 		params["finished"] = _finished;
 	}
 
+	const CmdRouter<Boring_night> Boring_night::_router{
+		{{"ok"}, [](Boring_night & screen, const CmdSequence &) {
+			screen.game_log().advance();
+		}},
+	};
+
 	void maf::Boring_night::do_commands(const CmdSequence & commands) {
-		if (commands_match(commands, {"ok"})) {
-			game_log().advance();
-		} else {
+		if (!_router.dispatch(*this, commands)) {
 			Game_screen::do_commands(commands);
 		}
 	}
 
+	void maf::Boring_night::list_commands(vector<CmdPattern> & patterns) const {
+		_router.list(*this, patterns);
+		Game_screen::list_commands(patterns);
+	}
+
 	void maf::Boring_night::set_params(TextParams& params) const {
 		// Nothing to do
 	}
 
+	const CmdRouter<Investigation_result> Investigation_result::_router{
+		{{"ok"}, [](Investigation_result & screen, const CmdSequence &) {
+			if (screen._finished) screen.game_log().advance();
+			else screen._finished = true;
+		}},
+	};
+
 	void maf::Investigation_result::do_commands(const CmdSequence & commands) {
-		if (commands_match(commands, {"ok"})) {
-			if (_finished) game_log().advance();
-			else _finished = true;
-		} else {
+		if (!_router.dispatch(*this, commands)) {
 			Game_screen::do_commands(commands);
 		}
 	}
 
+	void maf::Investigation_result::list_commands(vector<CmdPattern> & patterns) const {
+		_router.list(*this, patterns);
+		Game_screen::list_commands(patterns);
+	}
+
 	void maf::Investigation_result::set_params(TextParams& params) const {
 		params["caster"] = escaped_name(investigation.caster);
 		params["finished"] = _finished;
@@ -499,35 +636,52 @@ namespace maf {
 		params["target.suspicious"] = investigation.result;
 	}
 
+	const CmdRouter<Game_ended> Game_ended::_router{
+		{{"end"}, [](Game_ended & screen, const CmdSequence &) {
+			screen.console().end_game();
+		}},
+		{{"ok"}, [](Game_ended & screen, const CmdSequence &) {
+			screen.console().end_game();
+		}},
+	};
+
 	void maf::Game_ended::do_commands(const CmdSequence & commands) {
-		if (commands_match(commands, {"end"})
-			|| commands_match(commands, {"ok"}))
-		{
-			console().end_game();
-		} else {
+		if (!_router.dispatch(*this, commands)) {
 			Game_screen::do_commands(commands);
 		}
 	}
 
+	void maf::Game_ended::list_commands(vector<CmdPattern> & patterns) const {
+		_router.list(*this, patterns);
+		Game_screen::list_commands(patterns);
+	}
+
 	void maf::Game_ended::set_params(TextParams& params) const {
-		vector<TextParams> winners_params;
-		vector<TextParams> losers_params;
+		auto players = game_log().players();
+		auto num_winners = util::count_if(players, [](auto& player) {
+			return player.has_won();
+		});
 
-		for (auto& player: game_log().players()) {
-			TextParams subparams;
-			subparams["player"] = escaped_name(player);
-			subparams["role"] = escaped_name(player.role());
+		params["winners.size"] = static_cast<int>(num_winners);
+		params["losers.size"] = static_cast<int>(players.size() - num_winners);
 
-			if (player.has_won()) {
-				winners_params.push_back(move(subparams));
-			} else {
-				losers_params.push_back(move(subparams));
-			}
-		}
+		auto provide_players = [&](string_view key, bool winners) {
+			params.provide(key, [this, winners](TextParam & param) {
+				TextParamsList list{param.get_allocator()};
+
+				for (auto& player: game_log().players()) {
+					if (player.has_won() == winners) {
+						auto& subparams = list.emplace_back();
+						subparams["player"] = escaped_name(player);
+						subparams["role"] = escaped_name(player.role());
+					}
+				}
+
+				param = move(list);
+			});
+		};
 
-		params["winners.size"] = static_cast<int>(winners_params.size());
-		params["winners"] = move(winners_params);
-		params["losers.size"] = static_cast<int>(losers_params.size());
-		params["losers"] = move(losers_params);
+		provide_players("winners", true);
+		provide_players("losers", false);
 	}
 }
@@ -25,7 +25,12 @@ namespace maf {
 
 		fs::path txt_subdir() const override { return "txt/game_screens"; }
 
+		// The version of the game. Screens with state of their own combine
+		// it with the game's version using `_version_with`.
+		std::uint64_t state_version() const override { return _version_with(0); }
+
 		void do_commands(const CmdSequence & commands) override;
+		void list_commands(vector<CmdPattern> & patterns) const override;
 
 		// Write a summary of the event to `output`. This should be followed
 		// by calling `preprocess_text` with the screen's parameters.
@@ -33,6 +38,14 @@ namespace maf {
 
 		string escaped_name(const core::Player & player) const;
 		string escaped_name(const core::Role & role) const;
+
+	protected:
+		// Combine the version of the game with `local`, a number less than
+		// 2^16 describing the state of the screen itself.
+		std::uint64_t _version_with(std::uint64_t local) const;
+
+	private:
+		static const CmdRouter<Game_screen> _router;
 	};
 
 
@@ -44,10 +57,17 @@ namespace maf {
 
 		string_view id() const final { return "player-given-role"; }
 
+		std::uint64_t state_version() const override {
+			return _version_with(_is_private);
+		}
+
 		void do_commands(const CmdSequence & commands) override;
+		void list_commands(vector<CmdPattern> & patterns) const override;
 		void set_params(TextParams & params) const override;
 
 	private:
+		static const CmdRouter<Player_given_initial_role> _router;
+
 		not_null<const core::Player *> _player;
 		not_null<const core::Role *> _role;
 		bool _is_private{false};
@@ -61,7 +81,11 @@ namespace maf {
 		string_view id() const final { return "wildcards-resolved"; }
 
 		void do_commands(const CmdSequence & commands) override;
+		void list_commands(vector<CmdPattern> & patterns) const override;
 		void set_params(TextParams & params) const override;
+
+	private:
+		static const CmdRouter<Wildcards_resolved> _router;
 	};
 
 
@@ -75,7 +99,11 @@ namespace maf {
 		core::Time time;
 
 		void do_commands(const CmdSequence & commands) override;
+		void list_commands(vector<CmdPattern> & patterns) const override;
 		void set_params(TextParams & params) const override;
+
+	private:
+		static const CmdRouter<Time_changed> _router;
 	};
 
 
@@ -85,14 +113,21 @@ namespace maf {
 
 		string_view id() const final { return "obituary"; }
 
+		std::uint64_t state_version() const override {
+			return _version_with(static_cast<std::uint64_t>(_deaths_index + 1));
+		}
+
 		void do_commands(const CmdSequence & commands) override;
+		void list_commands(vector<CmdPattern> & patterns) const override;
 		void set_params(TextParams & params) const override;
 
 	private:
+		static const CmdRouter<Obituary> _router;
+
 		vector_of_refs<const core::Player> _deaths;
 		std::ptrdiff_t _deaths_index{-1};
 
-		TextParams _get_params(const core::Player & player) const;
+		void _set_params(TextParams & params, const core::Player & player) const;
 	};
 
 
@@ -117,9 +152,12 @@ namespace maf {
 		string_view id() const final { return "town-meeting"; }
 
 		void do_commands(const CmdSequence & commands) override;
+		void list_commands(vector<CmdPattern> & patterns) const override;
 		void set_params(TextParams & params) const override;
 
 	private:
+		static const CmdRouter<Town_meeting> _router;
+
 		vector_of_refs<const core::Player> _players;
 		core::Date _date;
 		bool _lynch_can_occur;
@@ -127,11 +165,7 @@ namespace maf {
 		const core::Player *_recent_vote_caster;
 		const core::Player *_recent_vote_target;
 
-		TextParams _get_params(const core::Player & player) const;
-
-		void _do_commands_before_lynch(const CmdSequence & commands);
-		void _do_commands_after_lynch(const CmdSequence & commands);
-		void _do_other_commands(const CmdSequence & commands);
+		void _set_params(TextParams & params, const core::Player & player) const;
 	};
 
 
@@ -142,9 +176,12 @@ namespace maf {
 		string_view id() const final { return "player-kicked"; }
 
 		void do_commands(const CmdSequence & commands) override;
+		void list_commands(vector<CmdPattern> & patterns) const override;
 		void set_params(TextParams & params) const override;
 
 	private:
+		static const CmdRouter<Player_kicked> _router;
+
 		const core::Player & _player;
 	};
 
@@ -162,7 +199,11 @@ namespace maf {
 		const core::Role *victim_role = nullptr;
 
 		void do_commands(const CmdSequence & commands) override;
+		void list_commands(vector<CmdPattern> & patterns) const override;
 		void set_params(TextParams & params) const override;
+
+	private:
+		static const CmdRouter<Lynch_result> _router;
 	};
 
 
@@ -181,7 +222,11 @@ namespace maf {
 		const core::Player & loser;
 
 		void do_commands(const CmdSequence & commands) override;
+		void list_commands(vector<CmdPattern> & patterns) const override;
 		void set_params(TextParams & params) const override;
+
+	private:
+		static const CmdRouter<Duel_result> _router;
 	};
 
 
@@ -191,10 +236,17 @@ namespace maf {
 
 		string_view id() const final { return "choose-fake-role"; }
 
+		std::uint64_t state_version() const override {
+			return _version_with(_finished);
+		}
+
 		void do_commands(const CmdSequence & commands) override;
+		void list_commands(vector<CmdPattern> & patterns) const override;
 		void set_params(TextParams & params) const override;
 
 	private:
+		static const CmdRouter<Choose_fake_role> _router;
+
 		not_null<const core::Player *> _player;
 		const core::Role * _fake_role{nullptr};
 		bool _finished{false};
@@ -210,16 +262,23 @@ namespace maf {
 
 		string_view id() const final { return "mafia-meeting"; }
 
+		std::uint64_t state_version() const override {
+			return _version_with(_finished);
+		}
+
 		void do_commands(const CmdSequence & commands) override;
+		void list_commands(vector<CmdPattern> & patterns) const override;
 		void set_params(TextParams & params) const override;
 
 	private:
+		static const CmdRouter<Mafia_meeting> _router;
+
 		vector_of_refs<const core::Player> _mafiosi;
 		bool _first_meeting;
 		bool _finished{false};
 
-		void _do_commands_for_first_meeting(const CmdSequence & commands);
-		void _do_commands_for_regular_meeting(const CmdSequence & commands);
+		// Whether the mafia can still choose to kill somebody.
+		bool _can_kill() const { return !_first_meeting && !_finished; }
 	};
 
 
@@ -229,10 +288,17 @@ namespace maf {
 
 		string_view id() const final { return "use-kill"; }
 
+		std::uint64_t state_version() const override {
+			return _version_with(_finished);
+		}
+
 		void do_commands(const CmdSequence & commands) override;
+		void list_commands(vector<CmdPattern> & patterns) const override;
 		void set_params(TextParams & params) const override;
 
 	private:
+		static const CmdRouter<Kill_use> _router;
+
 		const core::Player & _caster;
 		bool _finished{false};
 	};
@@ -244,10 +310,17 @@ namespace maf {
 
 		string_view id() const final { return "use-heal"; }
 
+		std::uint64_t state_version() const override {
+			return _version_with(_finished);
+		}
+
 		void do_commands(const CmdSequence & commands) override;
+		void list_commands(vector<CmdPattern> & patterns) const override;
 		void set_params(TextParams & params) const override;
 
 	private:
+		static const CmdRouter<Heal_use> _router;
+
 		const core::Player & _caster;
 		bool _finished{false};
 	};
@@ -259,10 +332,17 @@ namespace maf {
 
 		string_view id() const final { return "use-investigate"; }
 
+		std::uint64_t state_version() const override {
+			return _version_with(_finished);
+		}
+
 		void do_commands(const CmdSequence & commands) override;
+		void list_commands(vector<CmdPattern> & patterns) const override;
 		void set_params(TextParams & params) const override;
 
 	private:
+		static const CmdRouter<Investigate_use> _router;
+
 		const core::Player & _caster;
 		bool _finished{false};
 	};
@@ -274,10 +354,17 @@ namespace maf {
 
 		string_view id() const final { return "use-peddle"; }
 
+		std::uint64_t state_version() const override {
+			return _version_with(_finished);
+		}
+
 		void do_commands(const CmdSequence & commands) override;
+		void list_commands(vector<CmdPattern> & patterns) const override;
 		void set_params(TextParams & params) const override;
 
 	private:
+		static const CmdRouter<Peddle_use> _router;
+
 		const core::Player & _caster;
 		bool _finished{false};
 	};
@@ -289,7 +376,11 @@ namespace maf {
 		string_view id() const final { return "boring-night"; }
 
 		void do_commands(const CmdSequence & commands) override;
+		void list_commands(vector<CmdPattern> & patterns) const override;
 		void set_params(TextParams & params) const override;
+
+	private:
+		static const CmdRouter<Boring_night> _router;
 	};
 
 
@@ -299,12 +390,19 @@ namespace maf {
 
 		string_view id() const final { return "investigation-result"; }
 
+		std::uint64_t state_version() const override {
+			return _version_with(_finished);
+		}
+
 		core::Investigation investigation;
 
 		void do_commands(const CmdSequence & commands) override;
+		void list_commands(vector<CmdPattern> & patterns) const override;
 		void set_params(TextParams & params) const override;
 
 	private:
+		static const CmdRouter<Investigation_result> _router;
+
 		bool _finished{false};
 	};
 
@@ -315,7 +413,11 @@ namespace maf {
 		string_view id() const final { return "game-ended"; }
 
 		void do_commands(const CmdSequence & commands) override;
+		void list_commands(vector<CmdPattern> & patterns) const override;
 		void set_params(TextParams & params) const override;
+
+	private:
+		static const CmdRouter<Game_ended> _router;
 	};
 }
 
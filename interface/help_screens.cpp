@@ -6,14 +6,44 @@
 #include "names.hpp"
 
 namespace maf {
+	const CmdRouter<Help_Screen> Help_Screen::_router{
+		{{"ok"}, [](Help_Screen & screen, const CmdSequence &) {
+			screen.console().dismiss_help_screen();
+		}},
+	};
+
+	void Help_Screen::list_commands(vector<CmdPattern> & patterns) const {
+		_router.list(*this, patterns);
+		Screen::list_commands(patterns);
+	}
+
 	void Help_Screen::do_commands(const CmdSequence & commands) {
-		if (commands_match(commands, {"ok"})) {
-			console().dismiss_help_screen();
-		} else {
+		if (!_router.dispatch(*this, commands)) {
 			Screen::do_commands(commands);
 		}
 	}
 
+	void Game_help_screen::set_params(TextParams & params) const {
+		vector<CmdPattern> patterns;
+		game_screen.list_commands(patterns);
+
+		// A screen may handle a command which is also handled by its base
+		// class, in which case it's only listed once.
+		vector<string> described;
+		TextParamsList commands{params.get_allocator()};
+
+		for (auto pattern: patterns) {
+			auto str = describe(pattern);
+			if (util::find(described, str) != described.end()) continue;
+
+			auto& subparams = commands.emplace_back();
+			subparams["command"] = escaped(str);
+			described.push_back(move(str));
+		}
+
+		params["commands"] = move(commands);
+	}
+
 	void Role_Info_Screen::set_params(TextParams & params) const {
 		params["role"] = escaped(full_name(_role_id));
 	}
@@ -22,14 +52,12 @@ namespace maf {
 		return full_name(role_1) < full_name(role_2);
 	}
 
-	TextParams List_Roles_Screen::_get_params(const core::Role & role) {
-		TextParams params;
+	void List_Roles_Screen::_set_params(TextParams & params, const core::Role & role) {
 		params["role"] = escaped(full_name(role));
 		params["role.alias"] = escaped(role.alias());
 		params["role.aligned_to_village"] = (role.alignment() == core::Alignment::village);
 		params["role.aligned_to_mafia"] = (role.alignment() == core::Alignment::mafia);
 		params["role.aligned_to_freelance"] = (role.alignment() == core::Alignment::freelance);
-		return params;
 	}
 
 	vector_of_refs<const core::Role> List_Roles_Screen::_get_roles() const {
@@ -52,35 +80,44 @@ namespace maf {
 		params["show_mafia"] = (_filter_alignment == core::Alignment::mafia);
 		params["show_freelance"] = (_filter_alignment == core::Alignment::freelance);
 
-		auto roles = this->_get_roles();
-		params["roles"] = util::transformed_copy(roles, _get_params);
+		params.provide("roles", [this](TextParam & param) {
+			auto roles = this->_get_roles();
+			auto num_roles = roles.size();
+
+			param = TextParamsGenerator{num_roles,
+				[roles = move(roles)](std::size_t i, TextParams & item) {
+					_set_params(item, roles[i]);
+				}};
+		});
 	}
 
 	void maf::Player_Info_Screen::set_params(TextParams& params) const {
 		auto& game_log = console().game_log();
 		auto& game = game_log.game();
 
-		auto get_investigation_params = [&](const core::Investigation & investigation) {
-			TextParams params;
-			params["date"] = static_cast<int>(investigation.date);
-			params["target"] = escaped(game_log.get_name(investigation.target));
-			params["target.suspicious"] = investigation.result;
-			return params;
-		};
-
-		vector<TextParams> investigations;
-		for (auto& inv: game.investigations()) {
-			if (inv.caster == _player) {
-				investigations.push_back(get_investigation_params(inv));
+		params.provide("investigations", [this](TextParam & param) {
+			auto& game_log = console().game_log();
+
+			auto set_investigation_params = [&](TextParams & params, const core::Investigation & investigation) {
+				params["date"] = static_cast<int>(investigation.date);
+				params["target"] = escaped(game_log.get_name(investigation.target));
+				params["target.suspicious"] = investigation.result;
+			};
+
+			TextParamsList investigations{param.get_allocator()};
+			for (auto& inv: game_log.game().investigations()) {
+				if (inv.caster == _player) {
+					set_investigation_params(investigations.emplace_back(), inv);
+				}
 			}
-		}
+			param = move(investigations);
+		});
 
 		params["daytime"] = (game.time() == core::Time::day);
 		params["nighttime"] = (game.time() == core::Time::night);
 
 		params["player"] = escaped(game_log.get_name(_player));
 		params["role"] = escaped(full_name(_player.role()));
-		params["investigations"] = investigations;
 
 		if (_player.lynch_vote()) {
 			params["has_lynch_vote"] = true;
@@ -6,6 +6,7 @@
 
 #include "../core/core.hpp"
 
+#include "command.hpp"
 #include "format.hpp"
 #include "game_log.hpp"
 #include "game_screens.hpp"
@@ -18,16 +19,24 @@ namespace maf {
 		fs::path txt_subdir() const override { return "txt/help"; }
 
 		void do_commands(const CmdSequence & commands) override;
+		void list_commands(vector<CmdPattern> & patterns) const override;
+
+	private:
+		static const CmdRouter<Help_Screen> _router;
 	};
 
 
+	// A help screen listing the commands that `game_screen` can currently
+	// handle, generated from the same table that handles them.
 	struct Game_help_screen: Help_Screen {
 		Game_help_screen(Console & console, const Game_screen & screen):
 		Help_Screen{console}, game_screen{screen} { }
 
 		const Game_screen & game_screen;
 
-		string_view id() const final { return game_screen.id(); }
+		string_view id() const final { return "game-commands"; }
+
+		void set_params(TextParams & params) const override;
 	};
 
 
@@ -63,7 +72,7 @@ namespace maf {
 		optional<core::Alignment> _filter_alignment;
 
 		static bool _compare_by_name(const core::Role & role_1, const core::Role & role_2);
-		static TextParams _get_params(const core::Role & role);
+		static void _set_params(TextParams & params, const core::Role & role);
 
 		vector_of_refs<const core::Role> _get_roles() const;
 	};
@@ -1,5 +1,74 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+#include "../util/algorithm.hpp"
+
 #include "names.hpp"
 
+namespace maf::_names_impl {
+	// Fold `ch` to upper case, as when comparing names.
+	inline unsigned char fold(char ch) {
+		return static_cast<unsigned char>(std::toupper(static_cast<unsigned char>(ch)));
+	}
+
+	// The number of edits allowed when suggesting a name in place of a name
+	// with `size` characters.
+	inline std::size_t max_suggestion_distance(std::size_t size) {
+		return std::min(1 + size / 4, size / 2);
+	}
+
+	// A name to compare other names against, with a bit mask for each
+	// character marking where it appears in the name.
+	//
+	// # Preconditions
+	// - The name has at most 64 characters.
+	class bit_pattern {
+	public:
+		explicit bit_pattern(string_view name): _size{name.size()} {
+			for (std::size_t i = 0; i < name.size(); ++i) {
+				_masks[fold(name[i])] |= std::uint64_t{1} << i;
+			}
+		}
+
+		// The edit distance between this pattern and `name`, or any number
+		// greater than `max` if it's greater than `max`.
+		std::size_t distance(string_view name, std::size_t max) const {
+			if (_size == 0) return name.size();
+
+			auto last = std::uint64_t{1} << (_size - 1);
+			auto pv = ~std::uint64_t{0};
+			auto mv = std::uint64_t{0};
+			auto score = _size;
+
+			for (std::size_t j = 0; j < name.size(); ++j) {
+				auto eq = _masks[fold(name[j])];
+				auto xv = eq | mv;
+				auto xh = (((eq & pv) + pv) ^ pv) | eq;
+				auto ph = mv | ~(xh | pv);
+				auto mh = pv & xh;
+
+				if (ph & last) ++score;
+				else if (mh & last) --score;
+
+				// Each remaining character can lower the score by at most 1.
+				if (score > max + (name.size() - j - 1)) return max + 1;
+
+				ph = (ph << 1) | 1;
+				mh <<= 1;
+				pv = mh | ~(xv | ph);
+				mv = ph & xv;
+			}
+
+			return score;
+		}
+
+	private:
+		std::array<std::uint64_t, 256> _masks{};
+		std::size_t _size;
+	};
+}
+
 namespace maf {
 	string_view full_name(const core::Role & r) {
 		return full_name(r.id());
@@ -52,4 +121,176 @@ namespace maf {
 			return "random freelance";
 		}
 	}
+
+	std::size_t edit_distance(string_view name1, string_view name2) {
+		using namespace _names_impl;
+
+		if (name1.size() < name2.size()) swap(name1, name2);
+
+		if (name2.size() <= 64) {
+			return bit_pattern{name2}.distance(name1, name1.size());
+		}
+
+		// Fall back to the usual dynamic programming, one row at a time.
+		vector<std::size_t> row(name2.size() + 1);
+		for (std::size_t j = 0; j < row.size(); ++j) row[j] = j;
+
+		for (std::size_t i = 0; i < name1.size(); ++i) {
+			auto diagonal = row[0];
+			row[0] = i + 1;
+
+			for (std::size_t j = 0; j < name2.size(); ++j) {
+				auto cost = (fold(name1[i]) == fold(name2[j])) ? 0 : 1;
+				auto next = std::min({row[j + 1] + 1, row[j] + 1, diagonal + cost});
+				diagonal = row[j + 1];
+				row[j + 1] = next;
+			}
+		}
+
+		return row.back();
+	}
+
+	void Name_matcher::add(string_view name) {
+		if (_buckets.size() <= name.size()) _buckets.resize(name.size() + 1);
+		_buckets[name.size()].push_back(name);
+	}
+
+	void Name_matcher::remove(string_view name) {
+		if (name.size() >= _buckets.size()) return;
+
+		auto& bucket = _buckets[name.size()];
+		auto iter = util::find(bucket, name);
+
+		if (iter != bucket.end()) {
+			*iter = bucket.back();
+			bucket.pop_back();
+		}
+	}
+
+	void Name_matcher::clear() {
+		_buckets.clear();
+	}
+
+	vector<string_view> Name_matcher::closest(string_view name, std::size_t max_results) const {
+		using namespace _names_impl;
+
+		auto max = max_suggestion_distance(name.size());
+
+		// Names whose lengths differ by more than `max` can't be close enough.
+		auto min_size = (name.size() > max) ? name.size() - max : 0;
+		auto max_size = name.size() + max;
+
+		vector<pair<std::size_t, string_view>> matches;
+
+		auto check = [&](string_view other, std::size_t distance) {
+			if (distance <= max) matches.push_back({distance, other});
+		};
+
+		if (name.size() <= 64) {
+			bit_pattern pattern{name};
+
+			for (auto size = min_size; size <= max_size && size < _buckets.size(); ++size) {
+				for (auto other: _buckets[size]) check(other, pattern.distance(other, max));
+			}
+		} else {
+			for (auto size = min_size; size <= max_size && size < _buckets.size(); ++size) {
+				for (auto other: _buckets[size]) check(other, edit_distance(name, other));
+			}
+		}
+
+		auto num_results = std::min(max_results, matches.size());
+		std::partial_sort(matches.begin(), matches.begin() + num_results, matches.end());
+
+		vector<string_view> results;
+		for (std::size_t i = 0; i < num_results; ++i) results.push_back(matches[i].second);
+		return results;
+	}
+
+	void Name_trie::add(string_view name) {
+		std::size_t index = 0;
+		++_nodes[0].count;
+
+		for (auto ch: name) {
+			auto folded = _names_impl::fold(ch);
+			auto child = _child(index, folded);
+
+			if (child == npos) {
+				child = _nodes.size();
+				auto& children = _nodes[index].children;
+				auto iter = std::lower_bound(children.begin(), children.end(),
+					pair{folded, std::size_t{0}});
+				children.insert(iter, {folded, child});
+				_nodes.emplace_back();
+			}
+
+			index = child;
+			++_nodes[index].count;
+		}
+
+		_nodes[index].names.emplace_back(name);
+	}
+
+	void Name_trie::remove(string_view name) {
+		vector<std::size_t> path{0};
+
+		for (auto ch: name) {
+			auto child = _child(path.back(), _names_impl::fold(ch));
+			if (child == npos) return;
+			path.push_back(child);
+		}
+
+		auto& names = _nodes[path.back()].names;
+		auto iter = util::find(names, name);
+		if (iter == names.end()) return;
+
+		names.erase(iter);
+
+		// Empty nodes are kept, but skipped when searching.
+		for (auto index: path) --_nodes[index].count;
+	}
+
+	void Name_trie::clear() {
+		_nodes.assign(1, node{});
+	}
+
+	vector<string_view> Name_trie::complete(string_view prefix, std::size_t max_results) const {
+		vector<string_view> results;
+		std::size_t index = 0;
+
+		for (auto ch: prefix) {
+			index = _child(index, _names_impl::fold(ch));
+			if (index == npos) return results;
+		}
+
+		_collect(index, max_results, results);
+		return results;
+	}
+
+	std::size_t Name_trie::_child(std::size_t parent, unsigned char ch) const {
+		auto& children = _nodes[parent].children;
+		auto iter = std::lower_bound(children.begin(), children.end(), ch,
+			[](auto& child, unsigned char ch) { return child.first < ch; });
+
+		if (iter != children.end() && iter->first == ch) {
+			return iter->second;
+		} else {
+			return npos;
+		}
+	}
+
+	void Name_trie::_collect(std::size_t index, std::size_t max_results,
+		vector<string_view> & results) const
+	{
+		auto& n = _nodes[index];
+
+		for (auto& name: n.names) {
+			if (results.size() == max_results) return;
+			results.push_back(name);
+		}
+
+		for (auto [_, child]: n.children) {
+			if (results.size() == max_results) return;
+			if (_nodes[child].count > 0) _collect(child, max_results, results);
+		}
+	}
 }
@@ -1,7 +1,12 @@
 #ifndef MAFIA_NAMES_H
 #define MAFIA_NAMES_H
 
+#include <cstddef>
+#include <unordered_map>
+
+#include "../util/char.hpp"
 #include "../util/string.hpp"
+#include "../util/vector.hpp"
 
 #include "../core/core.hpp"
 
@@ -17,6 +22,122 @@ namespace maf {
 		}
 	};
 
+	// Function object hashing a name, ignoring differences in case.
+	struct Name_hash {
+		using is_transparent = void;
+
+		std::size_t operator()(string_view name) const {
+			// FNV-1a, applied to the upper-case form of each character.
+			std::size_t hash = 14695981039346656037u;
+
+			for (unsigned char ch: name) {
+				hash ^= static_cast<unsigned char>(std::toupper(ch));
+				hash *= 1099511628211u;
+			}
+
+			return hash;
+		}
+	};
+
+	// Function object checking if two names are equal, ignoring differences
+	// in case.
+	struct Name_equal {
+		using is_transparent = void;
+
+		bool operator()(string_view name1, string_view name2) const {
+			return util::equal_up_to_case(name1, name2);
+		}
+	};
+
+	// A table of names, each mapped to a value of type `T`. A name can be
+	// found in constant time, ignoring differences in case.
+	//
+	// Only views into the names are stored, so each name must outlive its
+	// entry in the table. This lets the table index names owned by another
+	// container without storing them a second time.
+	template <typename T>
+	using Name_index = std::unordered_map<string_view, T, Name_hash, Name_equal>;
+
+	// The number of single-character insertions, deletions and substitutions
+	// needed to turn `name1` into `name2`, ignoring differences in case.
+	std::size_t edit_distance(string_view name1, string_view name2);
+
+	// A list of names, used to suggest corrections for a name which may have
+	// been misspelt.
+	//
+	// The names are grouped by length, so that only the names which are
+	// short enough to be suggested need to be compared. Each comparison is
+	// made a column at a time using bit-parallel arithmetic, as described by
+	// Myers and Hyyrö.
+	//
+	// Only views into the names are stored, so each name must outlive the
+	// matcher or be removed from it first.
+	class Name_matcher {
+	public:
+		// Add `name` to the list.
+		void add(string_view name);
+		// Remove `name` from the list, if it's there. The name must match
+		// exactly, including case.
+		void remove(string_view name);
+		// Remove every name from the list.
+		void clear();
+
+		// Up to `max_results` names from the list which are close to `name`,
+		// closest first. Names which are too far from `name` to be a likely
+		// misspelling are never included.
+		vector<string_view> closest(string_view name, std::size_t max_results = 3) const;
+
+	private:
+		// The names of each length, indexed by length.
+		vector<vector<string_view>> _buckets{};
+	};
+
+	// A set of names, which can be searched for every name beginning with a
+	// given prefix, ignoring differences in case.
+	//
+	// The names are stored in a trie keyed by their upper-case characters,
+	// so a search only visits the names that it finds, however many names
+	// there are.
+	class Name_trie {
+	public:
+		// Add a copy of `name` to the set.
+		void add(string_view name);
+		// Remove `name` from the set, if it's there. The name must match
+		// exactly, including case.
+		void remove(string_view name);
+		// Remove every name from the set.
+		void clear();
+
+		// Up to `max_results` names in the set beginning with `prefix`,
+		// ignoring differences in case. The names are sorted in the order
+		// of their upper-case forms, and are views into the set.
+		vector<string_view> complete(string_view prefix, std::size_t max_results) const;
+
+	private:
+		struct node {
+			// The upper-case character following this node, together with
+			// the index of the node that it leads to, sorted by character.
+			vector<pair<unsigned char, std::size_t>> children{};
+			// The names ending at this node.
+			vector<string> names{};
+			// The number of names ending at this node or below it.
+			std::size_t count{0};
+		};
+
+		vector<node> _nodes = vector<node>(1);
+
+		// The index of the node following `ch` from `parent`, or `npos` if
+		// there is none.
+		std::size_t _child(std::size_t parent, unsigned char ch) const;
+
+		// Add the names at `index` and below it to `results`, until there
+		// are `max_results` of them.
+		void _collect(std::size_t index, std::size_t max_results,
+			vector<string_view> & results) const;
+
+		static constexpr std::size_t npos = -1;
+	};
+
 	/* FIXME */
 	// The category of the given wildcard.
 	string_view category(const core::Wildcard & wildcard);
@@ -2,13 +2,23 @@
 #include "console.hpp"
 #include "questions.hpp"
 
+const maf::CmdRouter<maf::Confirm_end_game> maf::Confirm_end_game::_router{
+	{{"yes"}, [](Confirm_end_game & screen, const CmdSequence &) {
+		screen.console().end_game();
+		screen.console().dismiss_question();
+	}},
+	{{"no"}, [](Confirm_end_game & screen, const CmdSequence &) {
+		screen.console().dismiss_question();
+	}},
+};
+
+void maf::Confirm_end_game::list_commands(vector<CmdPattern> & patterns) const {
+	_router.list(*this, patterns);
+	Question::list_commands(patterns);
+}
+
 void maf::Confirm_end_game::do_commands(const CmdSequence & commands) {
-	if (commands_match(commands, {"yes"})) {
-		console().end_game();
-		console().dismiss_question();
-	} else if (commands_match(commands, {"no"})) {
-		console().dismiss_question();
-	} else {
+	if (!_router.dispatch(*this, commands)) {
 		Question::do_commands(commands);
 	}
 }
@@ -1,6 +1,7 @@
 #ifndef MAFIA_INTERFACE_QUESTIONS
 #define MAFIA_INTERFACE_QUESTIONS
 
+#include "command.hpp"
 #include "screen.hpp"
 
 namespace maf {
@@ -20,6 +21,10 @@ namespace maf {
 		string_view id() const override { return "end-game"; }
 
 		void do_commands(const CmdSequence & commands) override;
+		void list_commands(vector<CmdPattern> & patterns) const override;
+
+	private:
+		static const CmdRouter<Confirm_end_game> _router;
 	};
 
 
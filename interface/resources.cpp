@@ -0,0 +1,275 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../util/fstream.hpp"
+#include "../util/memory.hpp"
+#include "../util/span.hpp"
+#include "../util/vector.hpp"
+
+#include "resources.hpp"
+
+namespace maf::_resources_impl {
+	using Bad_pack = resources::Bad_pack;
+
+	inline auto all_embedded_resources() -> span<const embedded_resource> {
+		return {embedded_resources, num_embedded_resources};
+	}
+
+	inline auto find_embedded(string_view path) -> optional<string_view> {
+		auto resources = all_embedded_resources();
+
+		auto iter = std::lower_bound(resources.begin(), resources.end(), path,
+			[](const embedded_resource & res, string_view path) {
+				return res.path < path;
+			});
+
+		if (iter != resources.end() && iter->path == path) {
+			return iter->contents;
+		} else {
+			return nullopt;
+		}
+	}
+
+	// A resource pack mapped into memory.
+	class mapped_pack {
+	public:
+		// Map the pack at `path` into memory and check that its index is
+		// valid.
+		//
+		// # Exceptions
+		// - Throws `Bad_pack` if the pack couldn't be mapped or is invalid.
+		explicit mapped_pack(fs::path path) : _path{move(path)} {
+			_map();
+
+			try {
+				_verify();
+			} catch (...) {
+				_unmap();
+				throw;
+			}
+
+			for (auto & entry: _entries()) {
+				auto embedded = find_embedded(_path_of(entry));
+				if (!embedded || *embedded != _contents_of(entry)) {
+					_changed_paths.push_back(_path_of(entry));
+				}
+			}
+		}
+
+		mapped_pack(const mapped_pack &) = delete;
+		mapped_pack & operator=(const mapped_pack &) = delete;
+
+		~mapped_pack() { _unmap(); }
+
+		// Find the contents of the resource at `path` in the pack.
+		optional<string_view> find(string_view path) const {
+			auto entries = _entries();
+
+			auto iter = std::lower_bound(entries.begin(), entries.end(), path,
+				[&](const pack_entry & entry, string_view path) {
+					return _path_of(entry) < path;
+				});
+
+			if (iter != entries.end() && _path_of(*iter) == path) {
+				return _contents_of(*iter);
+			} else {
+				return nullopt;
+			}
+		}
+
+		// Whether the resource at `path` is in the pack, with different
+		// contents to the copy compiled into the application.
+		bool is_changed(string_view path) const {
+			return std::binary_search(_changed_paths.begin(), _changed_paths.end(), path);
+		}
+
+	private:
+		fs::path _path;
+		const char * _data{nullptr};
+		std::size_t _size{0};
+		// The paths of the resources for which `is_changed` is true, sorted.
+		vector<string_view> _changed_paths{};
+
+		[[noreturn]] void _fail(Bad_pack::Reason reason) const {
+			throw Bad_pack{_path, reason};
+		}
+
+		void _map() {
+			int fd = ::open(_path.c_str(), O_RDONLY);
+			if (fd == -1) _fail(Bad_pack::Reason::cannot_open);
+
+			struct stat info;
+			if (::fstat(fd, &info) == -1) {
+				::close(fd);
+				_fail(Bad_pack::Reason::cannot_open);
+			}
+
+			_size = static_cast<std::size_t>(info.st_size);
+
+			if (_size < sizeof(pack_header)) {
+				::close(fd);
+				_fail(Bad_pack::Reason::bad_header);
+			}
+
+			void * addr = ::mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+			::close(fd);
+
+			if (addr == MAP_FAILED) _fail(Bad_pack::Reason::cannot_map);
+			_data = static_cast<const char *>(addr);
+		}
+
+		void _unmap() {
+			if (_data) ::munmap(const_cast<char *>(_data), _size);
+			_data = nullptr;
+		}
+
+		const pack_header & _header() const {
+			return *reinterpret_cast<const pack_header *>(_data);
+		}
+
+		span<const pack_entry> _entries() const {
+			auto first = reinterpret_cast<const pack_entry *>(_data + sizeof(pack_header));
+			return {first, _header().num_entries};
+		}
+
+		string_view _path_of(const pack_entry & entry) const {
+			return {_data + entry.path_offset, entry.path_size};
+		}
+
+		string_view _contents_of(const pack_entry & entry) const {
+			return {_data + entry.contents_offset, entry.contents_size};
+		}
+
+		bool _in_bounds(std::uint32_t offset, std::uint32_t size) const {
+			return offset <= _size && size <= _size - offset;
+		}
+
+		void _verify() const {
+			auto & header = _header();
+
+			if (std::memcmp(header.magic, pack_magic, sizeof(pack_magic)) != 0
+				|| header.version != pack_version)
+			{
+				_fail(Bad_pack::Reason::bad_header);
+			}
+
+			auto max_entries = (_size - sizeof(pack_header)) / sizeof(pack_entry);
+			if (header.num_entries > max_entries) {
+				_fail(Bad_pack::Reason::bad_index);
+			}
+
+			optional<string_view> prev_path;
+
+			for (auto & entry: _entries()) {
+				if (!_in_bounds(entry.path_offset, entry.path_size)
+					|| !_in_bounds(entry.contents_offset, entry.contents_size))
+				{
+					_fail(Bad_pack::Reason::bad_index);
+				}
+
+				// Paths must be strictly increasing for `find` to work.
+				auto path = _path_of(entry);
+				if (prev_path && !(*prev_path < path)) {
+					_fail(Bad_pack::Reason::bad_index);
+				}
+				prev_path = path;
+			}
+		}
+	};
+
+	// The pack opened by `resources::open_pack`, if any.
+	inline unique_ptr<const mapped_pack> global_pack;
+
+	// The result of `resources::is_overridden` for each path checked so far.
+	inline std::map<string, bool, std::less<>> overridden_paths;
+	inline std::mutex overridden_mutex;
+}
+
+maf::optional<maf::fs::path> maf::resources::override_dir() {
+	if (auto dir = std::getenv(override_dir_variable); dir && *dir) {
+		return fs::path{dir};
+	} else {
+		return nullopt;
+	}
+}
+
+maf::string maf::resources::Bad_pack::message() const {
+	string msg;
+
+	switch (reason) {
+	case Reason::cannot_open:
+		msg += "Couldn't open the resource pack at ";
+		break;
+	case Reason::cannot_map:
+		msg += "Couldn't map into memory the resource pack at ";
+		break;
+	case Reason::bad_header:
+		msg += "Unrecognised header in the resource pack at ";
+		break;
+	case Reason::bad_index:
+		msg += "Invalid index in the resource pack at ";
+		break;
+	}
+
+	msg += path.string();
+	return msg;
+}
+
+void maf::resources::open_pack() {
+	using namespace _resources_impl;
+
+	if (auto path = std::getenv(pack_variable); path && *path) {
+		global_pack = make_unique<const mapped_pack>(path);
+	}
+}
+
+bool maf::resources::is_overridden(const fs::path & path) {
+	using namespace _resources_impl;
+
+	auto key = path.generic_string();
+
+	std::lock_guard lock{overridden_mutex};
+
+	if (auto iter = overridden_paths.find(key); iter != overridden_paths.end()) {
+		return iter->second;
+	}
+
+	bool overridden = false;
+
+	if (auto dir = override_dir(); dir && fs::exists(*dir / path)) {
+		overridden = true;
+	} else if (global_pack && global_pack->is_changed(key)) {
+		overridden = true;
+	}
+
+	overridden_paths.emplace(move(key), overridden);
+	return overridden;
+}
+
+auto maf::resources::load(const fs::path & path) -> optional<Resource> {
+	using namespace _resources_impl;
+
+	if (auto dir = override_dir()) {
+		if (ifstream input{*dir / path}; input) {
+			return Resource{util::read_all(input)};
+		}
+	}
+
+	auto key = path.generic_string();
+
+	if (global_pack) {
+		if (auto contents = global_pack->find(key)) return Resource{*contents};
+	}
+
+	if (auto contents = find_embedded(key)) return Resource{*contents};
+
+	return nullopt;
+}
@@ -0,0 +1,148 @@
+#ifndef MAFIA_INTERFACE_RESOURCES_H
+#define MAFIA_INTERFACE_RESOURCES_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../util/filesystem.hpp"
+#include "../util/memory.hpp"
+#include "../util/optional.hpp"
+#include "../util/string.hpp"
+
+namespace maf::resources {
+	// The name of the environment variable which can be set to a directory
+	// containing resources to use instead of those compiled into the
+	// application. Intended for editing ".txt" files during development.
+	inline constexpr const char * override_dir_variable = "MAFIA_RESOURCES_DIR";
+
+	// The name of the environment variable which can be set to the path of a
+	// resource pack, as created by `tools/embed_resources.cpp --pack`.
+	inline constexpr const char * pack_variable = "MAFIA_RESOURCE_PACK";
+
+	// The directory named by the `MAFIA_RESOURCES_DIR` environment variable,
+	// if it has been set.
+	optional<fs::path> override_dir();
+
+	// An error thrown when a resource pack can't be used.
+	struct Bad_pack {
+		enum class Reason {
+			cannot_open,
+			cannot_map,
+			bad_header,
+			bad_index
+		};
+
+		fs::path path;
+		Reason reason;
+
+		// Get a description of the error.
+		string message() const;
+	};
+
+	// Map the resource pack named by the `MAFIA_RESOURCE_PACK` environment
+	// variable into memory, so that resources are served from it rather
+	// than from the copies compiled into the application. Does nothing if
+	// the variable hasn't been set.
+	//
+	// The pack is mapped read-only and shared, so every process using the
+	// same pack shares a single copy of it in memory. It stays mapped until
+	// the program exits.
+	//
+	// This should be called once at startup, before any resources are
+	// loaded.
+	//
+	// # Exceptions
+	// Throws `Bad_pack` if the pack couldn't be mapped or isn't valid. The
+	// compiled-in resources continue to be used in this case.
+	void open_pack();
+
+	// Whether the resource at `path` may differ from the copy compiled into
+	// the application. This is the case if it's in the override directory,
+	// or if the resource pack's copy of it isn't the same as the
+	// application's.
+	//
+	// The answer for each path is worked out the first time that it's asked
+	// for, and remembered from then on. Files added to the override
+	// directory afterwards aren't noticed until the program is restarted,
+	// but changes to files already there are.
+	bool is_overridden(const fs::path & path);
+
+	// The contents of a resource.
+	//
+	// Resources from the pack or the application are viewed where they are,
+	// and remain valid until the program exits. Those read from the override
+	// directory are owned by the `Resource` itself.
+	class Resource {
+	public:
+		// View `contents`, which must remain valid until the program exits.
+		explicit Resource(string_view contents) : _str{contents} { }
+
+		// Take ownership of `contents`.
+		explicit Resource(string && contents)
+		: _owned{make_unique<const string>(move(contents))}, _str{*_owned} { }
+
+		string_view str() const { return _str; }
+
+		// Whether `str()` remains valid until the program exits, rather than
+		// only for as long as this object.
+		bool is_static() const { return !_owned; }
+
+	private:
+		// Held by pointer so that `_str` survives moves.
+		unique_ptr<const string> _owned{};
+		string_view _str;
+	};
+
+	// Get the contents of the resource at `path`, which is relative to the
+	// "resources" directory, e.g. `"txt/help/setup.txt"`.
+	//
+	// Resources are looked for in the following places, in order:
+	// 1. the override directory, if one has been set;
+	// 2. the resource pack, if one has been opened;
+	// 3. the resources compiled into the application.
+	//
+	// Resources from the pack or the application are returned without being
+	// copied. Those from the override directory are read again each time.
+	//
+	// # Returns
+	// The contents of the resource, or `nullopt` if no such resource exists.
+	optional<Resource> load(const fs::path & path);
+}
+
+namespace maf::_resources_impl {
+	// A resource compiled into the application.
+	struct embedded_resource {
+		// The path of the resource, relative to the "resources" directory and
+		// using '/' as a separator.
+		string_view path;
+		string_view contents;
+	};
+
+	// Every resource compiled into the application, sorted by path. These
+	// are defined in a source file generated by `tools/embed_resources.cpp`.
+	extern const embedded_resource embedded_resources[];
+	extern const std::size_t num_embedded_resources;
+
+	// A resource pack consists of a `pack_header`, followed by an array of
+	// `pack_entry`s sorted by path, followed by the paths and contents of
+	// every resource. All integers are stored in the host's byte order.
+	struct pack_header {
+		char magic[8];
+		std::uint32_t version;
+		std::uint32_t num_entries;
+	};
+
+	// The location of a single resource in a pack. Offsets are measured from
+	// the start of the pack.
+	struct pack_entry {
+		std::uint32_t path_offset;
+		std::uint32_t path_size;
+		std::uint32_t contents_offset;
+		std::uint32_t contents_size;
+	};
+
+	inline constexpr char pack_magic[8] = {'M', 'A', 'F', 'P', 'A', 'C', 'K', '\0'};
+	inline constexpr std::uint32_t pack_version = 1;
+}
+
+#endif
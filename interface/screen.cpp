@@ -1,82 +1,197 @@
-#include "../util/fstream.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <memory_resource>
+#include <mutex>
+
 #include "../util/misc.hpp"
 
 #include "../core/core.hpp"
 
 #include "command.hpp"
 #include "console.hpp"
+#include "resources.hpp"
 #include "screen.hpp"
 
+namespace maf::_screen_impl {
+	// A screen explaining `error`, written so that it can itself be used as
+	// a template.
+	inline string describe_error(preprocess_text_error const& error) {
+		string str;
+		str += "=Error!=\n\nERROR: ";
+		str += escaped(error.message());
+		str += " in the following string:\n\n`";
+		str += escaped(error.input);
+		return str;
+	}
+
+	// The templates parsed from each ".txt" file so far. Templates are never
+	// removed, so they remain valid for the whole program.
+	//
+	// Overridden files are left out of the cache, so that edits to them are
+	// seen the next time the screen is written.
+	class template_cache {
+	public:
+		shared_ptr<const TextTemplate> get(const Screen & screen) {
+			auto path = screen.txt_path();
+
+			if (resources::is_overridden(path)) {
+				return make_shared<const TextTemplate>(compile(screen.load_txt()));
+			}
+
+			std::lock_guard lock{_mutex};
+
+			auto iter = _templates.find(path);
+
+			if (iter == _templates.end()) {
+				auto txt = make_shared<const TextTemplate>(compile(screen.load_txt()));
+				iter = _templates.emplace(move(path), move(txt)).first;
+			}
+
+			return iter->second;
+		}
+
+	private:
+		std::mutex _mutex;
+		std::map<fs::path, shared_ptr<const TextTemplate>> _templates;
+
+		// Parse `txt` into a template, which views `txt` in place if it
+		// remains valid for the whole program.
+		static TextTemplate compile(const resources::Resource & txt) {
+			try {
+				if (txt.is_static()) {
+					return TextTemplate::viewing(txt.str());
+				} else {
+					return TextTemplate{txt.str()};
+				}
+			} catch (const preprocess_text_error & error) {
+				return TextTemplate{describe_error(error)};
+			}
+		}
+	};
+
+	inline template_cache global_template_cache;
+
+	// The commands understood by every screen, unless overridden.
+	const CmdRouter<Screen> router{
+		{{"help", "role", CmdSlot::role}, [](Screen & screen, const CmdSequence & commands) {
+			try {
+				const core::Role & role = screen.console().active_rulebook().look_up(commands[2]);
+				screen.console().show_help_screen<Role_Info_Screen>(role);
+			} catch (std::out_of_range const&) {
+				throw core::Rulebook::Missing_role_alias{std::string(commands[2])};
+			}
+		}},
+		{{"list", "roles"}, [](Screen & screen, const CmdSequence &) {
+			screen.console().show_help_screen<List_Roles_Screen>();
+		}},
+		{{"list", "roles", "village"}, [](Screen & screen, const CmdSequence &) {
+			screen.console().show_help_screen<List_Roles_Screen>(core::Alignment::village);
+		}},
+		{{"list", "roles", "mafia"}, [](Screen & screen, const CmdSequence &) {
+			screen.console().show_help_screen<List_Roles_Screen>(core::Alignment::mafia);
+		}},
+		{{"list", "roles", "freelance"}, [](Screen & screen, const CmdSequence &) {
+			screen.console().show_help_screen<List_Roles_Screen>(core::Alignment::freelance);
+		}},
+		{{"info", CmdSlot::player}, [](Screen & screen, const CmdSequence & commands) {
+			auto& player = screen.console().game_log().find_player(commands[1]);
+			screen.console().show_help_screen<Player_Info_Screen>(player);
+		}},
+		{{"refresh"}, [](Screen &, const CmdSequence &) {
+			// do nothing
+		}},
+	};
+}
+
 namespace maf {
 	fs::path Screen::txt_path() const {
-		auto path = application::root_dir();
-		path /= "resources";
-		path /= this->txt_subdir();
+		auto path = this->txt_subdir();
 		path /= this->id();
 		path += ".txt";
 		return path;
 	}
 
-	string Screen::load_txt() const {
+	resources::Resource Screen::load_txt() const {
+		auto path = this->txt_path();
+
+		if (auto resource = resources::load(path)) {
+			return move(*resource);
+		}
+
 		string contents;
+		contents += "=Error!=\n\nERROR: No text found for the `";
+		contents += escaped(this->id());
+		contents += "` screen.\n\nIt should be located at `";
+		contents += escaped(("resources" / path).generic_string());
+		contents += "`.\n\n$Enter `ok` to return to the previous screen.";
+		return resources::Resource{move(contents)};
+	}
 
+	std::uint64_t Screen::_next_serial() {
+		static std::atomic<std::uint64_t> next{0};
+		return next++;
+	}
+
+	shared_ptr<const TextTemplate> Screen::txt_template() const {
+		return _screen_impl::global_template_cache.get(*this);
+	}
+
+	const CompiledTextTemplate * Screen::compiled_txt() const {
 		auto path = this->txt_path();
 
-		if (ifstream input{path}; input) {
-			contents = util::read_all(input);
+		if (resources::is_overridden(path)) {
+			return nullptr;
 		} else {
-			contents += "=Error!=\n\nERROR: No text found for the `";
-			contents += escaped(this->id());
-			contents += "` screen.\n\nIt should be located at `";
-			contents += escaped(path.native());
-			contents += "`.\n\n$Enter `ok` to return to the previous screen.";
+			return find_compiled_template(path.generic_string());
 		}
-
-		return contents;
 	}
 
-	void Screen::write(string & output) const {
-		auto raw_txt = this->load_txt();
+	void Screen::write(TextSink & output) const {
+		// Build the parameters in an arena, released in one go once the
+		// screen has been written.
+		std::array<std::byte, 16 * 1024> buffer;
+		std::pmr::monotonic_buffer_resource arena{buffer.data(), buffer.size()};
+
+		TextParams params{&arena};
+
+		// Lazy parameters are only provided if the template can read them.
+		auto compiled = this->compiled_txt();
+		auto txt = compiled ? nullptr : this->txt_template();
+		params.restrict_to(compiled ? compiled->param_names : txt->param_names());
 
-		TextParams params;
 		this->set_params(params);
 
+		if (compiled) {
+			compiled->render(output, params);
+		} else {
+			txt->write(output, params);
+		}
+	}
+
+	void Screen::write(string & output) const {
+		auto size = output.size();
+
 		try {
-			output += preprocess_text(raw_txt, params);
+			StringSink sink{output};
+			this->write(sink);
 		} catch (const preprocess_text_error & error) {
-			output += "=Error!=\n\nERROR: ";
-			output += escaped(error.message());
-			output += " in the following string:\n\n`";
-			output += escaped(error.input);
+			output.resize(size);
+			output += _screen_impl::describe_error(error);
 		}
 	}
 
+	void Screen::list_commands(vector<CmdPattern> & patterns) const {
+		_screen_impl::router.list(*this, patterns);
+	}
+
 	void Screen::do_commands(const CmdSequence & commands) {
 		if (commands.size() == 0) {
 			string msg = "=Missing input!=\n\nEntering a blank input has no effect.\n(enter `help` if you're unsure what to do.)";
 			auto params = TextParams{};
 			throw Generic_error{move(msg), move(params)};
-		} else if (commands_match(commands, {"help", "role", ""})) {
-			try {
-				const core::Role & role = console().active_rulebook().look_up(commands[2]);
-				console().show_help_screen<Role_Info_Screen>(role);
-			} catch (std::out_of_range const&) {
-				throw core::Rulebook::Missing_role_alias{std::string(commands[2])};
-			}
-		} else if (commands_match(commands, {"list", "roles"})) {
-			console().show_help_screen<List_Roles_Screen>();
-		} else if (commands_match(commands, {"list", "roles", "village"})) {
-			console().show_help_screen<List_Roles_Screen>(core::Alignment::village);
-		} else if (commands_match(commands, {"list", "roles", "mafia"})) {
-			console().show_help_screen<List_Roles_Screen>(core::Alignment::mafia);
-		} else if (commands_match(commands, {"list", "roles", "freelance"})) {
-			console().show_help_screen<List_Roles_Screen>(core::Alignment::freelance);
-		} else if (commands_match(commands, {"info", ""})) {
-			auto& player = console().game_log().find_player(commands[1]);
-			console().show_help_screen<Player_Info_Screen>(player);
-		} else if (commands_match(commands, {"refresh"})) {
-			// do nothing
-		} else {
+		} else if (!_screen_impl::router.dispatch(*this, commands)) {
 			throw Bad_commands{};
 		}
 	}
@@ -1,12 +1,16 @@
 #ifndef MAFIA_INTERFACE_SCREEN_H
 #define MAFIA_INTERFACE_SCREEN_H
 
+#include <cstdint>
+
 #include "../util/filesystem.hpp"
 #include "../util/memory.hpp"
 #include "../util/string.hpp"
+#include "../util/vector.hpp"
 
 #include "command.hpp"
 #include "format.hpp"
+#include "resources.hpp"
 
 namespace maf {
 	struct Console;
@@ -18,7 +22,7 @@ namespace maf {
 		//
 		// Note that only a pointer to `console` is stored. As such, the
 		// lifetime of this screen must not outlive the console.
-		Screen(Console & console) : _console{&console} {}
+		Screen(Console & console) : _console{&console}, _serial{_next_serial()} {}
 
 		virtual ~Screen() = default;
 
@@ -29,21 +33,62 @@ namespace maf {
 		// resources from the file system.
 		virtual string_view id() const = 0;
 
+		// A number which no other screen created by the program shares.
+		std::uint64_t serial() const { return _serial; }
+
+		// A number which changes whenever the text written for this screen
+		// might change, so that the text can be reused for as long as it
+		// stays the same. Defaults to 0, for screens whose text never
+		// changes.
+		virtual std::uint64_t state_version() const { return 0; }
+
 		// A string indicating which subdirectory of "resources" contains the
 		// ".txt" file for this screen. Defaults to "txt".
 		virtual fs::path txt_subdir() const { return "txt"; }
-		// The complete path of the ".txt" file for this screen.
+		// The path of the ".txt" file for this screen, relative to the
+		// "resources" directory.
 		fs::path txt_path() const;
-		// Open the ".txt" file for this screen and read its contents into a
-		// string.
-		string load_txt() const;
+		// Get the contents of the ".txt" file for this screen from the
+		// application's resources. If there is no such file, a description
+		// of the problem is returned instead.
+		resources::Resource load_txt() const;
+		// The contents of the ".txt" file for this screen, parsed into a
+		// template.
+		//
+		// Templates are kept in a process-wide cache keyed by path, so the
+		// file is only read and parsed the first time that it's needed. The
+		// exception is a file which has been overridden, which is read and
+		// parsed again each time, so that edits to it show up straight away.
+		// If the file can't be parsed, the template describes the error
+		// instead.
+		shared_ptr<const TextTemplate> txt_template() const;
+		// The function compiled from the ".txt" file for this screen at build
+		// time, or `nullptr` if there is none. Compiled functions are not
+		// used when the ".txt" file has been overridden, since they may no
+		// longer match it.
+		const CompiledTextTemplate * compiled_txt() const;
 
 		// Fill `params` with this screen's text parameters. Does nothing by
 		// default.
+		//
+		// Parameters which are expensive to compute, such as lists, should be
+		// set using `params.provide`, so that they're only computed if the
+		// template actually reads them.
 		virtual void set_params(TextParams & params) const {};
 
-		// Apply `preprocess_text` to the contents of the ".txt" file for this
-		// screen, and write the result to `output`.
+		// Preprocess the template for this screen using its text parameters,
+		// and write the result to `output`. The compiled function for the
+		// template is used if there is one.
+		//
+		// # Exceptions
+		// Throws `preprocess_text_error` if the template couldn't be
+		// preprocessed. Some of the result may already have been written to
+		// `output` when this happens.
+		void write(TextSink & output) const;
+
+		// Preprocess the template for this screen as above, and append the
+		// result to `output`. If the template couldn't be preprocessed, an
+		// explanation of the error is appended instead.
 		void write(string & output) const;
 
 		// Attempt to apply the given commands to the console. Each screen
@@ -56,11 +101,22 @@ namespace maf {
 		// Throws `Bad_commands` if the commands couldn't be handled.
 		virtual void do_commands(const CmdSequence & commands);
 
+		// Add a pattern to `patterns` for each of the commands that this
+		// screen can currently handle. The patterns are used to suggest
+		// completions for commands.
+		//
+		// By default, add the patterns for the help screens handled by the
+		// default `do_commands`.
+		virtual void list_commands(vector<CmdPattern> & patterns) const;
+
 		// An error thrown when a screen fails to handle a set of commands.
 		struct Bad_commands {};
 
 	private:
 		not_null<Console *> _console;
+		std::uint64_t _serial;
+
+		static std::uint64_t _next_serial();
 	};
 }
 
@@ -55,7 +55,84 @@ namespace maf {
 			{}
 		}
 	};
+}
+
+namespace maf::_setup_screen_impl {
+	// The commands understood by the setup screen.
+	const CmdRouter<Setup_screen> router{
+		{{"begin"}, [](Setup_screen & screen, const CmdSequence &) {
+			auto new_game = screen.begin_pending_game();
+			screen.console().store_game(move(new_game));
+		}},
+		{{"preset"}, [](Setup_screen & screen, const CmdSequence &) {
+			int num_presets = _presets.size();
+			auto n = util::random::uniform_int_trial(0, num_presets - 1);
+			auto new_game = screen.begin_preset(n);
+			screen.console().store_game(move(new_game));
+		}},
+		{{"preset", CmdSlot::text}, [](Setup_screen & screen, const CmdSequence & commands) {
+			int i;
+			string_view str = commands[1];
+
+			if (auto result = util::from_chars(str, i);
+			    result.ec == std::errc{})
+			{
+				auto new_game = screen.begin_preset(i);
+				screen.console().store_game(move(new_game));
+			} else {
+				string msg = "=Error!=\n\nThe string `{str}` could not be converted into a preset index. (i.e. a relatively-small integer)";
+				auto params = TextParams{};
+				params["str"] = escaped(str);
+
+				throw Generic_error{move(msg), move(params)};
+			}
+		}},
+		{{"add", "player", CmdSlot::text}, [](Setup_screen & screen, const CmdSequence & commands) {
+			screen.add_player(commands[2]);
+		}},
+		{{"take", "player", CmdSlot::player}, [](Setup_screen & screen, const CmdSequence & commands) {
+			screen.remove_player(commands[2]);
+		}},
+		{{"clear", "players"}, [](Setup_screen & screen, const CmdSequence &) {
+			screen.clear_all_players();
+		}},
+		{{"add", "role", CmdSlot::role}, [](Setup_screen & screen, const CmdSequence & commands) {
+			screen.add_rolecard(commands[2]);
+		}},
+		{{"take", "role", CmdSlot::role}, [](Setup_screen & screen, const CmdSequence & commands) {
+			screen.remove_rolecard(commands[2]);
+		}},
+		{{"clear", "role", CmdSlot::role}, [](Setup_screen & screen, const CmdSequence & commands) {
+			screen.clear_rolecards(commands[2]);
+		}},
+		{{"clear", "roles"}, [](Setup_screen & screen, const CmdSequence &) {
+			screen.clear_all_rolecards();
+		}},
+		{{"add", "wildcard", CmdSlot::wildcard}, [](Setup_screen & screen, const CmdSequence & commands) {
+			screen.add_wildcard(commands[2]);
+		}},
+		{{"take", "wildcard", CmdSlot::wildcard}, [](Setup_screen & screen, const CmdSequence & commands) {
+			screen.remove_wildcard(commands[2]);
+		}},
+		{{"clear", "wildcard", CmdSlot::wildcard}, [](Setup_screen & screen, const CmdSequence & commands) {
+			screen.clear_wildcards(commands[2]);
+		}},
+		{{"clear", "wildcards"}, [](Setup_screen & screen, const CmdSequence &) {
+			screen.clear_all_wildcards();
+		}},
+		{{"clear", "cards"}, [](Setup_screen & screen, const CmdSequence &) {
+			screen.clear_all_cards();
+		}},
+		{{"clear", "all"}, [](Setup_screen & screen, const CmdSequence &) {
+			screen.clear_all();
+		}},
+		{{"help"}, [](Setup_screen & screen, const CmdSequence &) {
+			screen.console().show_help_screen<Setup_Help_Screen>();
+		}},
+	};
+}
 
+namespace maf {
 	const core::Rulebook & Setup_screen::rulebook() const {
 		return _rulebook;
 	}
@@ -81,12 +158,7 @@ namespace maf {
 	}
 
 	bool Setup_screen::has_player(string_view name) const {
-		for (string_view s: _player_names) {
-			if (util::equal_up_to_case(s, name)) {
-				return true;
-			}
-		}
-		return false;
+		return _player_index.contains(name);
 	}
 
 	bool Setup_screen::has_rolecard(string_view alias) const {
@@ -128,16 +200,23 @@ namespace maf {
 	}
 
 	void Setup_screen::add_player(string_view name) {
+		++_version;
+
 		if (util::any_of(name, [](char ch) { return !std::isalnum(ch); })) {
 			throw Bad_player_name{string{name}};
 		} else if (has_player(name)) {
 			throw Player_already_exists{string{name}};
 		} else {
-			_player_names.insert(string{name});
+			auto iter = _player_names.insert(string{name}).first;
+			_player_index.emplace(*iter, iter);
+			_player_matcher.add(*iter);
+			_player_trie.add(*iter);
 		}
 	}
 
 	void Setup_screen::add_rolecard(string_view alias) {
+		++_version;
+
 		core::RoleRef r_ref{alias};
 
 		try {
@@ -150,24 +229,33 @@ namespace maf {
 	}
 
 	void Setup_screen::add_wildcard(string_view alias) {
+		++_version;
+
 		auto& wildcard = _rulebook.get_wildcard(alias);
 		auto& count = _wildcard_ids[wildcard.id()];
 		++count;
 	}
 
 	void Setup_screen::remove_player(string_view name) {
-		auto it = util::find_if(_player_names, [&name](string_view s) {
-			return util::equal_up_to_case(s, name);
-		});
+		++_version;
+
+		auto it = _player_index.find(name);
 
-		if (it == _player_names.end()) {
-			throw Player_missing{string{name}};
+		if (it == _player_index.end()) {
+			auto suggestions = _player_matcher.closest(name);
+			throw Player_missing{string{name}, {suggestions.begin(), suggestions.end()}};
 		} else {
-			_player_names.erase(it);
+			auto name_iter = it->second;
+			_player_matcher.remove(*name_iter);
+			_player_trie.remove(*name_iter);
+			_player_index.erase(it);
+			_player_names.erase(name_iter);
 		}
 	}
 
 	void Setup_screen::remove_rolecard(string_view alias) {
+		++_version;
+
 		core::RoleRef r_ref = alias;
 
 		try {
@@ -185,6 +273,8 @@ namespace maf {
 	}
 
 	void Setup_screen::remove_wildcard(string_view alias) {
+		++_version;
+
 		auto& wildcard = _rulebook.get_wildcard(alias);
 		auto& count = _wildcard_ids[wildcard.id()];
 
@@ -196,10 +286,17 @@ namespace maf {
 	}
 
 	void Setup_screen::clear_all_players() {
+		++_version;
+
 		_player_names.clear();
+		_player_index.clear();
+		_player_matcher.clear();
+		_player_trie.clear();
 	}
 
 	void Setup_screen::clear_rolecards(string_view alias) {
+		++_version;
+
 		core::RoleRef r_ref = alias;
 
 		try {
@@ -211,15 +308,21 @@ namespace maf {
 	}
 
 	void Setup_screen::clear_all_rolecards() {
+		++_version;
+
 		_role_ids.clear();
 	}
 
 	void Setup_screen::clear_wildcards(string_view alias) {
+		++_version;
+
 		const core::Wildcard & w = _rulebook.get_wildcard(alias);
 		_wildcard_ids[w.id()] = 0;
 	}
 
 	void Setup_screen::clear_all_wildcards() {
+		++_version;
+
 		_wildcard_ids.clear();
 	}
 
@@ -248,94 +351,55 @@ namespace maf {
 		}
 	}
 
-	void Setup_screen::do_commands(const vector<string_view> & commands) {
-		if (commands_match(commands, {"begin"})) {
-			auto new_game = begin_pending_game();
-			console().store_game(move(new_game));
-		} else if (commands_match(commands, {"preset"})) {
-			int num_presets = _presets.size();
-			auto n = util::random::uniform_int_trial(0, num_presets - 1);
-			auto new_game = begin_preset(n);
-			console().store_game(move(new_game));
-		} else if (commands_match(commands, {"preset", ""})) {
-			int i;
-			string_view str = commands[1];
-
-			if (auto result = util::from_chars(str, i);
-			    result.ec == std::errc{})
-			{
-				auto new_game = begin_preset(i);
-				console().store_game(move(new_game));
-			} else {
-				string msg = "=Error!=\n\nThe string `{str}` could not be converted into a preset index. (i.e. a relatively-small integer)";
-				auto params = TextParams{};
-				params["str"] = escaped(str);
-
-				throw Generic_error{move(msg), move(params)};
-			}
-		} else if (commands_match(commands, {"add", "player", ""})) {
-			add_player(commands[2]);
-		} else if (commands_match(commands, {"take", "player", ""})) {
-			remove_player(commands[2]);
-		} else if (commands_match(commands, {"clear", "players"})) {
-			clear_all_players();
-		} else if (commands_match(commands, {"add", "role", ""})) {
-			add_rolecard(commands[2]);
-		} else if (commands_match(commands, {"take", "role", ""})) {
-			remove_rolecard(commands[2]);
-		} else if (commands_match(commands, {"clear", "role", ""})) {
-			clear_rolecards(commands[2]);
-		} else if (commands_match(commands, {"clear", "roles"})) {
-			clear_all_rolecards();
-		} else if (commands_match(commands, {"add", "wildcard", ""})) {
-			add_wildcard(commands[2]);
-		} else if (commands_match(commands, {"take", "wildcard", ""})) {
-			remove_wildcard(commands[2]);
-		} else if (commands_match(commands, {"clear", "wildcard", ""})) {
-			clear_wildcards(commands[2]);
-		} else if (commands_match(commands, {"clear", "wildcards"})) {
-			clear_all_wildcards();
-		} else if (commands_match(commands, {"clear", "cards"})) {
-			clear_all_cards();
-		} else if (commands_match(commands, {"clear", "all"})) {
-			clear_all();
-		} else if (commands_match(commands, {"help"})) {
-			console().show_help_screen<Setup_Help_Screen>();
-		} else {
+	void Setup_screen::do_commands(const CmdSequence & commands) {
+		if (!_setup_screen_impl::router.dispatch(*this, commands)) {
 			Screen::do_commands(commands);
 		}
 	}
 
+	void Setup_screen::list_commands(vector<CmdPattern> & patterns) const {
+		_setup_screen_impl::router.list(*this, patterns);
+		Screen::list_commands(patterns);
+	}
+
 	void Setup_screen::set_params(TextParams & params) const {
-		vector<TextParams> players;
-		vector<TextParams> cards;
+		TextParamsList players{params.get_allocator()};
 
 		for (auto&& player_name: _player_names) {
 			auto& subparams = players.emplace_back();
 			subparams["player"] = player_name;
 		}
 
-		for (auto&& [role_id, count]: _role_ids) {
-			if (count > 0) {
-				auto& subparams = cards.emplace_back();
-				subparams["card"] = escaped(full_name(role_id));
-				subparams["count"] = static_cast<int>(count);
-				subparams["type"] = 1;
+		auto is_chosen = [](auto&& card) { return card.second > 0; };
+		auto num_cards = util::count_if(_role_ids, is_chosen)
+		               + util::count_if(_wildcard_ids, is_chosen);
+
+		params["players.size"] = static_cast<int>(players.size());
+		params["players"] = move(players);
+		params["cards.size"] = static_cast<int>(num_cards);
+
+		params.provide("cards", [this](TextParam & param) {
+			TextParamsList cards{param.get_allocator()};
+
+			for (auto&& [role_id, count]: _role_ids) {
+				if (count > 0) {
+					auto& subparams = cards.emplace_back();
+					subparams["card"] = escaped(full_name(role_id));
+					subparams["count"] = static_cast<int>(count);
+					subparams["type"] = 1;
+				}
 			}
-		}
 
-		for (auto&& [wildcard_id, count]: _wildcard_ids) {
-			if (count > 0) {
-				auto& subparams = cards.emplace_back();
-				subparams["card"] = escaped(alias(wildcard_id));
-				subparams["count"] = static_cast<int>(count);
-				subparams["type"] = 2;
+			for (auto&& [wildcard_id, count]: _wildcard_ids) {
+				if (count > 0) {
+					auto& subparams = cards.emplace_back();
+					subparams["card"] = escaped(alias(wildcard_id));
+					subparams["count"] = static_cast<int>(count);
+					subparams["type"] = 2;
+				}
 			}
-		}
 
-		params["players.size"] = static_cast<int>(players.size());
-		params["players"] = move(players);
-		params["cards.size"] = static_cast<int>(cards.size());
-		params["cards"] = move(cards);
+			param = move(cards);
+		});
 	}
 }
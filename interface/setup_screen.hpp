@@ -29,6 +29,8 @@ namespace maf {
 		// Signifies that no player with the given name exists.
 		struct Player_missing {
 			string name;
+			// The names of some players with similar names, closest first.
+			vector<string> suggestions{};
 		};
 
 		// Signifies that no copies of the given rolecard have been chosen.
@@ -63,6 +65,9 @@ namespace maf {
 
 		// Checks if a player with the given name already exists.
 		bool has_player(string_view name) const;
+		// The names of the players who have been chosen, for completing
+		// names as they're typed.
+		const Name_trie & player_trie() const { return _player_trie; }
 		// Checks if at least one rolecard with the given alias has been chosen.
 		bool has_rolecard(string_view alias) const;
 		// Checks if at least one wildcard with the given alias has been chosen.
@@ -113,12 +118,24 @@ namespace maf {
 		// appropriate.
 		// Throws an exception if the commands couldn't be interpreted.
 		void do_commands(const CmdSequence & commands) override;
+		void list_commands(vector<CmdPattern> & patterns) const override;
 
 		void set_params(TextParams & params) const override;
 
+		std::uint64_t state_version() const override { return _version; }
+
 	private:
+		// Increased whenever a player or card is added or removed.
+		std::uint64_t _version{0};
 		core::Rulebook _rulebook{};
 		std::set<string> _player_names{};
+		// Each player's name in `_player_names`, found up to case. The keys
+		// are views into `_player_names`.
+		Name_index<std::set<string>::iterator> _player_index{};
+		// Used to suggest names when a player can't be found.
+		Name_matcher _player_matcher{};
+		// Used to complete names as they're typed.
+		Name_trie _player_trie{};
 		std::map<core::Role::ID, std::size_t, Role_ID_full_name_compare> _role_ids{};
 		std::map<core::Wildcard::ID, std::size_t> _wildcard_ids{};
 	};
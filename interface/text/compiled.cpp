@@ -0,0 +1,22 @@
+#include <algorithm>
+
+#include "../../util/span.hpp"
+
+#include "compiled.hpp"
+
+auto maf::find_compiled_template(string_view path) -> const CompiledTextTemplate * {
+	using namespace _compiled_template_impl;
+
+	span<const compiled_template> templates{compiled_templates, num_compiled_templates};
+
+	auto iter = std::lower_bound(templates.begin(), templates.end(), path,
+		[](const compiled_template & t, string_view path) {
+			return t.path < path;
+		});
+
+	if (iter != templates.end() && iter->path == path) {
+		return &iter->tmpl;
+	} else {
+		return nullptr;
+	}
+}
@@ -0,0 +1,56 @@
+#ifndef MAFIA_INTERFACE_TEXT_COMPILED_H
+#define MAFIA_INTERFACE_TEXT_COMPILED_H
+
+#include <cstddef>
+
+#include "../format.hpp"
+
+// Helpers for the functions generated by `tools/embed_resources.cpp`.
+//
+// Each helper behaves in the same way as the corresponding directive in
+// `preprocess_text`, including the errors that it throws.
+namespace maf::_compiled_template_impl {
+	// Write the parameter called `name` to `output`, as in `{name}`.
+	void write_param(TextSink & output, string_view name, TextParams const& params);
+
+	// Get the value of the boolean parameter called `name`, as in `{!if name}`.
+	bool bool_param(string_view name, TextParams const& params);
+
+	// Get the value of the integer parameter called `name`, as used in
+	// `{!if name < 3}`.
+	int int_param(string_view name, TextParams const& params);
+
+	// Get the list parameter called `name`, as in `{!list name}`. This holds
+	// either a `TextParamsList` or a `TextParamsGenerator`.
+	auto list_param(string_view name, TextParams const& params)
+	-> TextParam::value_type const&;
+
+	// Call `f` with the parameters for each item of the list parameter called
+	// `name`, as in `{!list name}`.
+	template <typename Function>
+	void for_each_item(string_view name, TextParams const& params, Function && f) {
+		auto& list = list_param(name, params);
+
+		if (auto items = std::get_if<TextParamsList>(&list)) {
+			for (auto& item: *items) f(item);
+		} else {
+			std::get<TextParamsGenerator>(list).for_each(f);
+		}
+	}
+
+	// A template compiled into the application.
+	struct compiled_template {
+		// The path of the template, relative to the "resources" directory and
+		// using '/' as a separator.
+		string_view path;
+		CompiledTextTemplate tmpl;
+	};
+
+	// Every template compiled into the application, sorted by path. These
+	// are defined in a source file generated by
+	// `tools/embed_resources.cpp`.
+	extern const compiled_template compiled_templates[];
+	extern const std::size_t num_compiled_templates;
+}
+
+#endif
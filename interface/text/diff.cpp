@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <cstdint>
+
+#include "../format.hpp"
+
+
+namespace maf::_styled_text_diff_impl {
+	using segment = StyledStringView;
+
+	// The largest table used to compare the changed segments of two texts.
+	// Past this, every changed segment is replaced in one edit.
+	constexpr std::size_t max_table_size = std::size_t{1} << 20;
+
+	bool equal(const segment & a, const segment & b) {
+		return a.str == b.str && a.attributes == b.attributes;
+	}
+
+	// Find the edits turning `a` into `b` using a table of the longest
+	// common subsequences of their suffixes, adding them to `edits`. The
+	// positions are offset by `offset`.
+	void diff_segments(span<const segment> a, span<const segment> b,
+		std::size_t offset, vector<StyledTextEdit> & edits)
+	{
+		auto n = a.size();
+		auto m = b.size();
+		auto width = m + 1;
+
+		// lcs[i * width + j] is the length of the longest common
+		// subsequence of `a[i..]` and `b[j..]`.
+		vector<std::uint32_t> lcs((n + 1) * width, 0);
+
+		for (auto i = n; i-- > 0; ) {
+			for (auto j = m; j-- > 0; ) {
+				if (equal(a[i], b[j])) {
+					lcs[i * width + j] = lcs[(i + 1) * width + j + 1] + 1;
+				} else {
+					lcs[i * width + j] = std::max(lcs[(i + 1) * width + j],
+					                              lcs[i * width + j + 1]);
+				}
+			}
+		}
+
+		// The edit being built up since the last common segment, if any.
+		StyledTextEdit * edit = nullptr;
+
+		auto current_edit = [&](std::size_t i) -> StyledTextEdit & {
+			if (!edit) edit = &edits.emplace_back(StyledTextEdit{offset + i, 0, {}});
+			return *edit;
+		};
+
+		for (std::size_t i = 0, j = 0; i < n || j < m; ) {
+			if (i < n && j < m && equal(a[i], b[j])) {
+				edit = nullptr;
+				++i;
+				++j;
+			} else if (j == m || (i < n && lcs[(i + 1) * width + j] >= lcs[i * width + j + 1])) {
+				++current_edit(i).num_removed;
+				++i;
+			} else {
+				current_edit(i).inserted.push_back(b[j]);
+				++j;
+			}
+		}
+	}
+}
+
+
+maf::vector<maf::StyledStringView> maf::segments(const StyledText & text) {
+	vector<StyledStringView> result;
+
+	for (auto [str, attributes]: text) {
+		while (!str.empty()) {
+			auto end = str.find('\n');
+			end = (end == string_view::npos) ? str.size() : end + 1;
+
+			result.push_back({str.substr(0, end), attributes});
+			str.remove_prefix(end);
+		}
+	}
+
+	return result;
+}
+
+
+auto maf::diff(const StyledText & old_text, const StyledText & new_text)
+-> vector<StyledTextEdit>
+{
+	using namespace _styled_text_diff_impl;
+
+	auto a = segments(old_text);
+	auto b = segments(new_text);
+
+	// Only the segments between the common prefix and the common suffix
+	// need to be compared.
+	std::size_t prefix = 0;
+
+	while (prefix < a.size() && prefix < b.size() && equal(a[prefix], b[prefix])) {
+		++prefix;
+	}
+
+	std::size_t suffix = 0;
+
+	while (suffix < a.size() - prefix && suffix < b.size() - prefix
+		&& equal(a[a.size() - 1 - suffix], b[b.size() - 1 - suffix]))
+	{
+		++suffix;
+	}
+
+	span<const segment> a_mid{a.data() + prefix, a.size() - prefix - suffix};
+	span<const segment> b_mid{b.data() + prefix, b.size() - prefix - suffix};
+
+	vector<StyledTextEdit> edits;
+
+	if (a_mid.empty() && b_mid.empty()) {
+		return edits;
+	} else if ((a_mid.size() + 1) * (b_mid.size() + 1) > max_table_size) {
+		edits.push_back({prefix, a_mid.size(), {b_mid.begin(), b_mid.end()}});
+	} else {
+		diff_segments(a_mid, b_mid, prefix, edits);
+	}
+
+	return edits;
+}
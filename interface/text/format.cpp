@@ -2,6 +2,8 @@
 #include "../../util/algorithm.hpp"
 #include "../../util/string.hpp"
 
+#include "scan.hpp"
+
 
 namespace maf::_format_text_impl {
 	using iterator = string_view::iterator;
@@ -25,12 +27,16 @@ namespace maf::_format_text_impl {
 		return is_delimiter(ch) || ch == '{' || ch == '}';
 	}
 
+	// The characters accepted by `is_delimiter` and `is_escapable`.
+	constexpr _text_scan_impl::char_set delimiters{"_*`=$~\\"};
+	constexpr _text_scan_impl::char_set escapables{"_*`=$~\\{}"};
+
 	iterator find_delimiter(iterator begin, iterator end) {
-		return std::find_if(begin, end, is_delimiter);
+		return _text_scan_impl::find_first_of(begin, end, delimiters);
 	}
 
 	iterator find_escapable(iterator begin, iterator end) {
-		return std::find_if(begin, end, is_escapable);
+		return _text_scan_impl::find_first_of(begin, end, escapables);
 	}
 
 	string escaped(iterator begin, iterator end) {
@@ -89,12 +95,14 @@ namespace maf::_format_text_impl {
 	}
 
 
-	void move_block(StyledText & text, string & block,
-		StyledString::attributes_t attributes)
+	// Mark the characters added to `buffer` since `block_begin` as a run
+	// with the given attributes, and start a new block after them.
+	void end_block(string const& buffer, vector<StyledText::run> & runs,
+		std::size_t & block_begin, StyledString::attributes_t attributes)
 	{
-		if (!block.empty()) {
-			text.emplace_back(block, attributes);
-			block.clear();
+		if (buffer.size() > block_begin) {
+			runs.push_back({block_begin, buffer.size() - block_begin, attributes});
+			block_begin = buffer.size();
 		}
 	}
 
@@ -226,8 +234,12 @@ namespace maf::_format_text_impl {
 	StyledText format_text(iterator begin, iterator end,
 		StyledString::attributes_t attributes)
 	{
-		string block;
-		StyledText output;
+		// Formatting codes and escape sequences only ever remove characters,
+		// so the output fits in a buffer the size of the input.
+		string buffer;
+		buffer.reserve(end - begin);
+		vector<StyledText::run> runs;
+		std::size_t block_begin = 0;
 
 		for (auto i = begin; ; ) {
 			auto j = find_delimiter(i, end);
@@ -242,19 +254,19 @@ namespace maf::_format_text_impl {
 			//          |            |
 			// "... `ok` to continue."
 
-			block.append(i, j);
+			buffer.append(i, j);
 
 			if (j == end) {
-				move_block(output, block, attributes);
-				return output;
+				end_block(buffer, runs, block_begin, attributes);
+				return {move(buffer), move(runs)};
 			}
 
 			if (char ch = *j; is_format_code(ch)) {
-				move_block(output, block, attributes);
+				end_block(buffer, runs, block_begin, attributes);
 				update_style(attributes, ch);
 				i = j + 1;
 			} else { // ch is a backslash
-				i = parse_escape_sequence(j, end, block);
+				i = parse_escape_sequence(j, end, buffer);
 			}
 		}
 	}
@@ -280,6 +292,88 @@ maf::StyledText maf::format_text(string_view input,
 }
 
 
+void maf::StyledTextWriter::write(string_view chunk) {
+	using namespace _format_text_impl;
+
+	try {
+		auto i = chunk.begin();
+		auto end = chunk.end();
+
+		if (_in_escape && i != end) {
+			// The backslash starting this escape sequence was at the end of
+			// the last chunk.
+			if (char ch = *i; is_escapable(ch)) {
+				_buffer += ch;
+			} else if (ch != '\n') {
+				auto substr = util::make_string_view(i, i + 1);
+				throw error{errc::invalid_escape_sequence, substr};
+			}
+
+			_in_escape = false;
+			_hard_end = _buffer.size();
+			++i;
+		}
+
+		while (i != end) {
+			auto j = find_delimiter(i, end);
+			_buffer.append(i, j);
+
+			if (j == end) break;
+
+			if (char ch = *j; is_format_code(ch)) {
+				_end_block();
+				update_style(_attributes, ch);
+				_hard_end = _buffer.size();
+				i = j + 1;
+			} else if (j + 1 == end) {
+				// ch is a backslash, and the rest of the escape sequence
+				// will be in the next chunk.
+				_in_escape = true;
+				i = end;
+			} else {
+				i = parse_escape_sequence(j, end, _buffer);
+				_hard_end = _buffer.size();
+			}
+		}
+	} catch (format_text_error & error) {
+		error.input = chunk;
+		throw;
+	}
+}
+
+
+void maf::StyledTextWriter::drop_whitespace_from_end() {
+	auto tail = string_view{_buffer}.substr(_hard_end);
+	_buffer.resize(_hard_end + util::drop_whitespace_from_end(tail).size());
+}
+
+
+maf::StyledText maf::StyledTextWriter::finish() {
+	using namespace _format_text_impl;
+
+	if (_in_escape) {
+		string_view backslash = "\\";
+		error e{errc::invalid_escape_sequence, backslash};
+		e.input = backslash;
+		throw e;
+	}
+
+	_end_block();
+
+	StyledText text{move(_buffer), move(_runs)};
+	_buffer.clear();
+	_runs.clear();
+	_block_begin = 0;
+	_hard_end = 0;
+	return text;
+}
+
+
+void maf::StyledTextWriter::_end_block() {
+	_format_text_impl::end_block(_buffer, _runs, _block_begin, _attributes);
+}
+
+
 maf::index maf::format_text_error::pos() const {
 	return param.begin() - input.begin();
 }
@@ -0,0 +1,158 @@
+#include <algorithm>
+
+#include "../../util/type_traits.hpp"
+#include "../../util/variant.hpp"
+
+#include "../format.hpp"
+
+namespace maf::_text_params_impl {
+	using value_type = TextParam::value_type;
+	using allocator_type = TextParam::allocator_type;
+
+	// Copy `value`, allocating any string or list with `alloc`.
+	inline value_type copy_value(const value_type & value, allocator_type alloc) {
+		return visit([&](auto && x) -> value_type {
+			using T = decay<decltype(x)>;
+
+			if constexpr (is_same<T, TextParam::string_type>
+			              || is_same<T, TextParamsList>)
+			{
+				return T(x, alloc);
+			} else {
+				return x;
+			}
+		}, value);
+	}
+
+	// Move `value`, allocating any string or list with `alloc`. The contents
+	// are only moved if they were allocated with `alloc` already.
+	inline value_type move_value(value_type && value, allocator_type alloc) {
+		return visit([&](auto && x) -> value_type {
+			using T = decay<decltype(x)>;
+
+			if constexpr (is_same<T, TextParam::string_type>
+			              || is_same<T, TextParamsList>)
+			{
+				return T(move(x), alloc);
+			} else {
+				return x;
+			}
+		}, move(value));
+	}
+}
+
+maf::TextParam::TextParam(const TextParam & other, allocator_type alloc)
+: _value{_text_params_impl::copy_value(other._value, alloc)},
+  _provider{other._provider},
+  _alloc{alloc}
+{ }
+
+maf::TextParam::TextParam(TextParam && other, allocator_type alloc)
+: _value{_text_params_impl::move_value(move(other._value), alloc)},
+  _provider{move(other._provider)},
+  _alloc{alloc}
+{ }
+
+maf::TextParam::TextParam(const TextParam & other)
+: TextParam{other, allocator_type{}}
+{ }
+
+maf::TextParam & maf::TextParam::operator=(const TextParam & other) {
+	if (this != &other) {
+		_value = _text_params_impl::copy_value(other._value, _alloc);
+		_provider = other._provider;
+	}
+
+	return *this;
+}
+
+maf::TextParam & maf::TextParam::operator=(TextParam && other) {
+	if (this != &other) {
+		_value = _text_params_impl::move_value(move(other._value), _alloc);
+		_provider = move(other._provider);
+	}
+
+	return *this;
+}
+
+maf::TextParam & maf::TextParam::operator=(bool b) {
+	_provider = nullptr;
+	_value = b;
+	return *this;
+}
+
+maf::TextParam & maf::TextParam::operator=(int i) {
+	_provider = nullptr;
+	_value = i;
+	return *this;
+}
+
+maf::TextParam & maf::TextParam::operator=(string_view str) {
+	_provider = nullptr;
+	_value.emplace<string_type>(str, _alloc);
+	return *this;
+}
+
+maf::TextParam & maf::TextParam::operator=(TextParamsList list) {
+	_provider = nullptr;
+	_value.emplace<TextParamsList>(move(list), _alloc);
+	return *this;
+}
+
+maf::TextParam & maf::TextParam::operator=(TextParamsGenerator generator) {
+	_provider = nullptr;
+	_value = move(generator);
+	return *this;
+}
+
+void maf::TextParam::provide(Provider provider) {
+	_provider = move(provider);
+}
+
+void maf::TextParam::_resolve() const {
+	// Clear the provider before calling it, so that it isn't called again
+	// if the parameter is read while being resolved.
+	auto provider = move(_provider);
+	_provider = nullptr;
+
+	// Parameters are never created as `const`, so this is safe.
+	provider(const_cast<TextParam &>(*this));
+}
+
+maf::TextParam & maf::TextParams::operator[](string_view key) {
+	auto iter = std::lower_bound(_entries.begin(), _entries.end(), key,
+		[](const value_type & entry, string_view key) {
+			return entry.first < key;
+		});
+
+	if (iter == _entries.end() || iter->first != key) {
+		iter = _entries.emplace(iter, std::piecewise_construct,
+			std::forward_as_tuple(key), std::forward_as_tuple());
+	}
+
+	return iter->second;
+}
+
+auto maf::TextParams::find(string_view key) const -> const_iterator {
+	auto iter = std::lower_bound(_entries.begin(), _entries.end(), key,
+		[](const value_type & entry, string_view key) {
+			return entry.first < key;
+		});
+
+	if (iter != _entries.end() && iter->first == key) {
+		return iter;
+	} else {
+		return _entries.end();
+	}
+}
+
+void maf::TextParams::provide(string_view key, TextParam::Provider provider) {
+	if (this->can_be_read(key)) {
+		(*this)[key].provide(move(provider));
+	}
+}
+
+bool maf::TextParams::can_be_read(string_view key) const {
+	return !_restricted
+		|| std::binary_search(_readable_keys.begin(), _readable_keys.end(), key);
+}
@@ -12,6 +12,8 @@
 #include "../../util/vector.hpp"
 
 #include "../format.hpp"
+#include "compiled.hpp"
+#include "scan.hpp"
 
 namespace maf::_preprocess_text_impl {
 	using iterator = string_view::iterator;
@@ -22,6 +24,10 @@ namespace maf::_preprocess_text_impl {
 		return ch == '{' || ch == '}';
 	}
 
+	// The characters accepted by `is_brace` and `util::is_whitespace`.
+	constexpr _text_scan_impl::char_set braces{"{}"};
+	constexpr _text_scan_impl::char_set whitespace{" \t\n\r"};
+
 	// # Example
 	// Given the following input:
 	// ```
@@ -31,7 +37,7 @@ namespace maf::_preprocess_text_impl {
 	// ```
 	// return `next`.
 	inline iterator find_brace(iterator begin, iterator end) {
-		return std::find_if(begin, end, is_brace);
+		return _text_scan_impl::find_first_of(begin, end, braces);
 	}
 
 	// # Example
@@ -43,7 +49,7 @@ namespace maf::_preprocess_text_impl {
 	// ```
 	// return `next`.
 	inline iterator skip_whitespace(iterator begin, iterator end) {
-		return std::find_if_not(begin, end, util::is_whitespace);
+		return _text_scan_impl::find_first_not_of(begin, end, whitespace);
 	}
 
 
@@ -77,7 +83,7 @@ namespace maf::_preprocess_text_impl {
 	-> ParamType const& {
 		auto& param = get_param(name, params);
 
-		if (auto ptr = std::get_if<ParamType>(&param)) {
+		if (auto ptr = std::get_if<ParamType>(&param.value())) {
 			return *ptr;
 		} else {
 			throw error{errc::wrong_parameter_type, name};
@@ -92,11 +98,11 @@ namespace maf::_preprocess_text_impl {
 	// - Throws `preprocess_text_error` with code `parameter_not_available` if
 	//   there is no parameter in `params` whose key is equal to `name`.
 	template <typename Visitor>
-		requires std::invocable<Visitor, TextParam>
+		requires std::invocable<Visitor, TextParam::value_type>
 	auto visit_param(Visitor && f, string_view name, TextParams const& params)
-	-> decltype(visit(f, TextParam{})) {
+	-> decltype(visit(f, TextParam::value_type{})) {
 		auto& param = get_param(name, params);
-		return visit(f, param);
+		return visit(f, param.value());
 	}
 
 
@@ -168,6 +174,15 @@ namespace maf::_preprocess_text_impl {
 		// `this->rel` to `less_than`, and return `next`.
 		iterator parse(iterator begin, iterator end);
 
+		// Append the names of any parameters used as operands to `names`.
+		void collect_param_names(vector<string_view> & names) const {
+			for (auto arg: {&arg_1, &arg_2}) {
+				if (auto name = std::get_if<string_view>(arg)) {
+					names.push_back(*name);
+				}
+			}
+		}
+
 		// Perform the comparison on `this->arg_1` and `this->arg_2`.
 		//
 		// Each operand is first converted to an integer value, by either:
@@ -219,6 +234,15 @@ namespace maf::_preprocess_text_impl {
 			return _get_value(pred, params);
 		}
 
+		// Append the names of any parameters used by the test to `names`.
+		void collect_param_names(vector<string_view> & names) const {
+			if (auto name = std::get_if<string_view>(&pred)) {
+				names.push_back(*name);
+			} else if (auto comp = std::get_if<comparison>(&pred)) {
+				comp->collect_param_names(names);
+			}
+		}
+
 	private:
 		static bool _get_value(bool val, TextParams const& params) {
 			return val;
@@ -502,10 +526,20 @@ namespace maf::_preprocess_text_impl {
 	}
 
 
+	struct cpp_writer;
+
 	struct expression {
 		virtual ~expression() = default;
-		virtual void write(string & output, TextParams const& params) const = 0;
+		virtual void write(TextSink & output, TextParams const& params) const = 0;
 		virtual iterator parse(iterator begin, iterator end, string_view input) = 0;
+
+		// Write C++ statements to `writer` which have the same effect as
+		// calling `write`.
+		virtual void write_cpp(cpp_writer & writer) const = 0;
+
+		// Append the name of every parameter which `write` might read from
+		// `params` to `names`.
+		virtual void collect_param_names(vector<string_view> & names) const = 0;
 	};
 
 
@@ -516,14 +550,21 @@ namespace maf::_preprocess_text_impl {
 			return ch == '\\' || ch == '{' || ch == '}';
 		}
 
+		// The characters accepted by `is_delimiter`.
+		static constexpr _text_scan_impl::char_set delimiters{"\\{}"};
+
 		static iterator find_delimiter(iterator begin, iterator end) {
-			return std::find_if(begin, end, is_delimiter);
+			return _text_scan_impl::find_first_of(begin, end, delimiters);
 		}
 
-		void write(string & output, TextParams const& params) const override {
-			output += str;
+		void write(TextSink & output, TextParams const&) const override {
+			output.write(str);
 		}
 
+		void write_cpp(cpp_writer & writer) const override;
+
+		void collect_param_names(vector<string_view> &) const override { }
+
 		// Form the largest possible subrange of `{begin, end}` starting from
 		// `begin` where none of the characters are braces. Append the
 		// subrange to `this->str`.
@@ -545,7 +586,9 @@ namespace maf::_preprocess_text_impl {
 	struct substitution: expression {
 		string_view param_name;
 
-		void write(string & output, TextParams const& params) const override;
+		void write(TextSink & output, TextParams const& params) const override;
+		void write_cpp(cpp_writer & writer) const override;
+		void collect_param_names(vector<string_view> & names) const override;
 
 		// # Example
 		// Given the following input:
@@ -562,7 +605,9 @@ namespace maf::_preprocess_text_impl {
 	struct sequence: expression {
 		vector<unique_ptr<expression>> subexprs;
 
-		void write(string & output, TextParams const& params) const override;
+		void write(TextSink & output, TextParams const& params) const override;
+		void write_cpp(cpp_writer & writer) const override;
+		void collect_param_names(vector<string_view> & names) const override;
 
 		iterator parse(iterator begin, iterator end, string_view input) override;
 
@@ -580,7 +625,9 @@ namespace maf::_preprocess_text_impl {
 		vector<conditional_sequence> cond_subexprs;
 		optional<sequence> default_subexpr;
 
-		void write(string & output, TextParams const& params) const override;
+		void write(TextSink & output, TextParams const& params) const override;
+		void write_cpp(cpp_writer & writer) const override;
+		void collect_param_names(vector<string_view> & names) const override;
 
 		// # Example
 		// Given the following input:
@@ -609,7 +656,9 @@ namespace maf::_preprocess_text_impl {
 		string_view param_name;
 		sequence subexpr;
 
-		void write(string & output, TextParams const& params) const override;
+		void write(TextSink & output, TextParams const& params) const override;
+		void write_cpp(cpp_writer & writer) const override;
+		void collect_param_names(vector<string_view> & names) const override;
 
 		// # Example
 		// Given the following input:
@@ -636,14 +685,14 @@ namespace maf::_preprocess_text_impl {
 	 */
 
 
-	inline void substitution::write(string & output, TextParams const& params) const {
+	inline void substitution::write(TextSink & output, TextParams const& params) const {
 		auto print = [&](auto&& arg) {
 			using T = decay<decltype(arg)>;
 
 			if constexpr (is_same<T, int>) {
-				output += std::to_string(arg);
-			} else if constexpr (is_same<T, string>) {
-				output += arg;
+				output.write(std::to_string(arg));
+			} else if constexpr (is_same<T, TextParam::string_type>) {
+				output.write(arg);
 			} else {
 				throw error{errc::wrong_parameter_type, param_name};
 			}
@@ -653,14 +702,14 @@ namespace maf::_preprocess_text_impl {
 	}
 
 
-	inline void sequence::write(string & output, TextParams const& params) const {
+	inline void sequence::write(TextSink & output, TextParams const& params) const {
 		for (auto & expr: this->subexprs) {
 			expr->write(output, params);
 		}
 	}
 
 
-	inline void conditional::write(string & output, TextParams const& params) const {
+	inline void conditional::write(TextSink & output, TextParams const& params) const {
 		for (auto& [test, expr]: this->cond_subexprs) {
 			bool use_this_subexpr = test.resolve(params);
 
@@ -674,10 +723,248 @@ namespace maf::_preprocess_text_impl {
 	}
 
 
-	inline void loop::write(string & output, TextParams const& params) const {
-		auto& vec = get_param_as<vector<TextParams>>(param_name, params);
+	inline void loop::write(TextSink & output, TextParams const& params) const {
+		_compiled_template_impl::for_each_item(param_name, params,
+			[&](TextParams const& subparams) {
+				subexpr.write(output, subparams);
+			});
+	}
+
 
-		for (auto&& subparams: vec) subexpr.write(output, subparams);
+	/*
+	 * Definitions of "collect_param_names" functions
+	 */
+
+
+	inline void substitution::collect_param_names(vector<string_view> & names) const {
+		names.push_back(param_name);
+	}
+
+
+	inline void sequence::collect_param_names(vector<string_view> & names) const {
+		for (auto & expr: this->subexprs) {
+			expr->collect_param_names(names);
+		}
+	}
+
+
+	inline void conditional::collect_param_names(vector<string_view> & names) const {
+		for (auto& [test, expr]: this->cond_subexprs) {
+			test.collect_param_names(names);
+			expr.collect_param_names(names);
+		}
+
+		if (default_subexpr) default_subexpr->collect_param_names(names);
+	}
+
+
+	inline void loop::collect_param_names(vector<string_view> & names) const {
+		// Parameters inside the loop are read from each item of the list,
+		// rather than from `params`.
+		names.push_back(param_name);
+	}
+
+
+	/*
+	 * Definitions of "write_cpp" functions
+	 */
+
+
+	// Accumulates the C++ code generated from a parsed template.
+	//
+	// The code refers to parameter names as substrings of a variable holding
+	// the template's source, so that errors thrown while rendering point
+	// into the source in the same way as errors thrown by `write`.
+	struct cpp_writer {
+		string & output;
+		string_view input;
+		string_view source_var;
+		// The number of blocks that the code is nested in.
+		int depth{1};
+		// The number of loops that the code is nested in, plus one.
+		int loop_depth{1};
+
+		void indent() {
+			output.append(depth, '\t');
+		}
+
+		// The name of the variable holding the parameters for the innermost
+		// loop, or for the whole template outside of any loops.
+		string params_var(int level) const {
+			return level == 1 ? "params"s : "params_"s + std::to_string(level);
+		}
+
+		string params_var() const {
+			return params_var(loop_depth);
+		}
+
+		// An expression for `name`, which must be a substring of `input`.
+		string name(string_view name) const {
+			string str{source_var};
+			str += ".substr(";
+			str += std::to_string(name.data() - input.data());
+			str += ", ";
+			str += std::to_string(name.size());
+			str += ")";
+			return str;
+		}
+
+		// Write `str` as a C++ string literal, split after every newline.
+		void write_literal(string_view str) {
+			output += '"';
+
+			for (auto i = str.begin(); i != str.end(); ++i) {
+				switch (char ch = *i) {
+				case '"':  output += "\\\""; break;
+				case '\\': output += "\\\\"; break;
+				case '\t': output += "\\t"; break;
+				case '\n':
+					output += "\\n\"";
+
+					if (i + 1 != str.end()) {
+						output += '\n';
+						indent();
+						output += "\t\"";
+					}
+
+					continue;
+
+				default:
+					if (ch >= ' ' && ch <= '~') {
+						output += ch;
+					} else {
+						// Octal escapes are at most three digits long, so
+						// they can't swallow any characters after them.
+						auto byte = static_cast<unsigned char>(ch);
+						output += '\\';
+						output += static_cast<char>('0' + (byte >> 6));
+						output += static_cast<char>('0' + ((byte >> 3) & 7));
+						output += static_cast<char>('0' + (byte & 7));
+					}
+				}
+			}
+
+			if (str.empty() || str.back() != '\n') output += '"';
+			output += "sv";
+		}
+
+		void write_operand(comparison::operand const& arg) {
+			if (auto integer = std::get_if<int>(&arg)) {
+				output += std::to_string(*integer);
+			} else {
+				output += "int_param(";
+				output += name(std::get<string_view>(arg));
+				output += ", ";
+				output += params_var();
+				output += ")";
+			}
+		}
+
+		void write_test(logical_test const& test) {
+			if (auto value = std::get_if<bool>(&test.pred)) {
+				output += *value ? "true" : "false";
+			} else if (auto param_name = std::get_if<string_view>(&test.pred)) {
+				output += "bool_param(";
+				output += name(*param_name);
+				output += ", ";
+				output += params_var();
+				output += ")";
+			} else {
+				auto& comp = std::get<comparison>(test.pred);
+				write_operand(comp.arg_1);
+
+				switch (comp.rel) {
+				case relation::equals: output += " == "; break;
+				case relation::less_than: output += " < "; break;
+				case relation::greater_than: output += " > "; break;
+				}
+
+				write_operand(comp.arg_2);
+			}
+		}
+	};
+
+
+	inline void plain_text::write_cpp(cpp_writer & writer) const {
+		if (str.empty()) return;
+
+		writer.indent();
+		writer.output += "output.write(";
+		writer.write_literal(str);
+		writer.output += ");\n";
+	}
+
+
+	inline void substitution::write_cpp(cpp_writer & writer) const {
+		writer.indent();
+		writer.output += "write_param(output, ";
+		writer.output += writer.name(param_name);
+		writer.output += ", ";
+		writer.output += writer.params_var();
+		writer.output += ");\n";
+	}
+
+
+	inline void sequence::write_cpp(cpp_writer & writer) const {
+		for (auto & expr: this->subexprs) {
+			expr->write_cpp(writer);
+		}
+	}
+
+
+	inline void conditional::write_cpp(cpp_writer & writer) const {
+		writer.indent();
+
+		for (auto& [test, expr]: this->cond_subexprs) {
+			writer.output += "if (";
+			writer.write_test(test);
+			writer.output += ") {\n";
+
+			++writer.depth;
+			expr.write_cpp(writer);
+			--writer.depth;
+
+			writer.indent();
+			writer.output += "}";
+
+			if (&expr != &this->cond_subexprs.back().second) {
+				writer.output += " else ";
+			}
+		}
+
+		if (default_subexpr) {
+			writer.output += " else {\n";
+
+			++writer.depth;
+			default_subexpr->write_cpp(writer);
+			--writer.depth;
+
+			writer.indent();
+			writer.output += "}";
+		}
+
+		writer.output += "\n";
+	}
+
+
+	inline void loop::write_cpp(cpp_writer & writer) const {
+		writer.indent();
+		writer.output += "for_each_item(";
+		writer.output += writer.name(param_name);
+		writer.output += ", ";
+		writer.output += writer.params_var();
+		writer.output += ", [&](TextParams const& ";
+		writer.output += writer.params_var(writer.loop_depth + 1);
+		writer.output += ") {\n";
+
+		++writer.depth;
+		++writer.loop_depth;
+		subexpr.write_cpp(writer);
+		--writer.loop_depth;
+		--writer.depth;
+
+		writer.indent();
+		writer.output += "});\n";
 	}
 
 
@@ -1118,31 +1405,175 @@ namespace maf::_preprocess_text_impl {
 }
 
 
-maf::string maf::preprocess_text(string_view input, TextParams const& params) {
-	using namespace _preprocess_text_impl;
+namespace maf::_preprocess_text_impl {
+	// Parse the whole of `input` into a sequence.
+	//
+	// # Exceptions
+	// - Throws `preprocess_text_error` with `input` set if `input` couldn't
+	//   be parsed.
+	inline void parse_input(sequence & expr, string_view input) {
+		try {
+			if (auto next = expr.parse(input.begin(), input.end(), input);
+				next != input.end())
+			{
+				directive dir;
+				dir.parse(next, input.end(), input);
 
+				auto cmd_name = dir.extract_command_name();
+				throw error{errc::unexpected_command, cmd_name};
+			}
+		} catch (preprocess_text_error & error) {
+			error.input = input;
+			throw;
+		}
+	}
+}
+
+
+maf::string maf::preprocess_text(string_view input, TextParams const& params) {
 	string output;
+	StringSink sink{output};
+	preprocess_text(input, params, sink);
+	return output;
+}
 
-	try {
-		sequence expr;
 
-		if (auto next = expr.parse(input.begin(), input.end(), input);
-			next != input.end())
-		{
-			directive dir;
-			dir.parse(next, input.end(), input);
+void maf::preprocess_text(string_view input, TextParams const& params,
+	TextSink & output)
+{
+	using namespace _preprocess_text_impl;
 
-			auto cmd_name = dir.extract_command_name();
-			throw error{errc::unexpected_command, cmd_name};
-		}
+	sequence expr;
+	parse_input(expr, input);
 
+	try {
 		expr.write(output, params);
 	} catch (preprocess_text_error & error) {
 		error.input = input;
 		throw;
 	}
+}
 
-	return output;
+
+maf::TextTemplate::TextTemplate(string_view source)
+: _owned_source{make_unique<const string>(source)}, _source{*_owned_source}
+{
+	_parse(source);
+}
+
+
+maf::TextTemplate maf::TextTemplate::viewing(string_view source) {
+	TextTemplate tmpl;
+	tmpl._source = source;
+	tmpl._parse(source);
+	return tmpl;
+}
+
+
+void maf::TextTemplate::_parse(string_view caller_source) {
+	using namespace _preprocess_text_impl;
+
+	auto expr = make_unique<sequence>();
+
+	try {
+		parse_input(*expr, _source);
+	} catch (preprocess_text_error & error) {
+		// Point the error at the caller's string, since ours may be about
+		// to be destroyed.
+		auto rebase = [&](string_view::iterator iter) {
+			return caller_source.begin() + (iter - error.input.begin());
+		};
+
+		auto rebase_param = [&](auto&& arg) -> decltype(error.param) {
+			using T = decay<decltype(arg)>;
+
+			if constexpr (is_same<T, iterator>) {
+				return rebase(arg);
+			} else {
+				return string_view{rebase(arg.begin()), arg.size()};
+			}
+		};
+
+		error.param = visit(rebase_param, error.param);
+		error.input = caller_source;
+		throw;
+	}
+
+	expr->collect_param_names(_param_names);
+	std::sort(_param_names.begin(), _param_names.end());
+	_param_names.erase(std::unique(_param_names.begin(), _param_names.end()),
+		_param_names.end());
+
+	_expr = move(expr);
+}
+
+
+maf::TextTemplate::TextTemplate(TextTemplate &&) noexcept = default;
+
+maf::TextTemplate & maf::TextTemplate::operator=(TextTemplate &&) noexcept = default;
+
+maf::TextTemplate::~TextTemplate() = default;
+
+
+void maf::TextTemplate::write(TextSink & output, TextParams const& params) const {
+	try {
+		_expr->write(output, params);
+	} catch (preprocess_text_error & error) {
+		error.input = _source;
+		throw;
+	}
+}
+
+
+void maf::TextTemplate::write_cpp(string & output, string_view source_var,
+	int indent) const
+{
+	using namespace _preprocess_text_impl;
+
+	cpp_writer writer{output, _source, source_var, indent};
+	_expr->write_cpp(writer);
+}
+
+
+void maf::_compiled_template_impl::write_param(TextSink & output,
+	string_view name, TextParams const& params)
+{
+	using namespace _preprocess_text_impl;
+
+	substitution subst;
+	subst.param_name = name;
+	subst.write(output, params);
+}
+
+
+bool maf::_compiled_template_impl::bool_param(string_view name,
+	TextParams const& params)
+{
+	return _preprocess_text_impl::get_param_as<bool>(name, params);
+}
+
+
+int maf::_compiled_template_impl::int_param(string_view name,
+	TextParams const& params)
+{
+	return _preprocess_text_impl::get_param_as<int>(name, params);
+}
+
+
+auto maf::_compiled_template_impl::list_param(string_view name,
+	TextParams const& params) -> TextParam::value_type const&
+{
+	using namespace _preprocess_text_impl;
+
+	auto& value = get_param(name, params).value();
+
+	if (std::holds_alternative<TextParamsList>(value)
+		|| std::holds_alternative<TextParamsGenerator>(value))
+	{
+		return value;
+	} else {
+		throw error{errc::wrong_parameter_type, name};
+	}
 }
 
 
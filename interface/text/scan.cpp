@@ -0,0 +1,138 @@
+#include <memory>
+
+#include "scan.hpp"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+	#define MAFIA_TEXT_SCAN_X86 1
+	#include <immintrin.h>
+#endif
+
+namespace maf::_text_scan_impl {
+	using scanner = const char * (*)(const char * begin, const char * end,
+		const char_set & set);
+
+	// Find the first character whose membership of `set` is `Match`, one
+	// byte at a time.
+	template <bool Match>
+	const char * scan_bytes(const char * begin, const char * end,
+		const char_set & set)
+	{
+		for (auto i = begin; i != end; ++i) {
+			if (set.contains(*i) == Match) return i;
+		}
+
+		return end;
+	}
+
+#ifdef MAFIA_TEXT_SCAN_X86
+	// As `scan_bytes`, but checking 16 bytes at a time.
+	template <bool Match>
+	__attribute__((target("sse2")))
+	const char * scan_sse2(const char * begin, const char * end,
+		const char_set & set)
+	{
+		auto chars = set.chars();
+		if (chars.empty()) return Match ? end : begin;
+
+		__m128i needles[char_set::capacity];
+
+		for (std::size_t k = 0; k < chars.size(); ++k) {
+			needles[k] = _mm_set1_epi8(chars[k]);
+		}
+
+		auto i = begin;
+
+		for (; end - i >= 16; i += 16) {
+			auto block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(i));
+			auto matches = _mm_cmpeq_epi8(block, needles[0]);
+
+			for (std::size_t k = 1; k < chars.size(); ++k) {
+				matches = _mm_or_si128(matches, _mm_cmpeq_epi8(block, needles[k]));
+			}
+
+			auto mask = static_cast<unsigned>(_mm_movemask_epi8(matches));
+			if constexpr (!Match) mask = ~mask & 0xffff;
+
+			if (mask != 0) return i + __builtin_ctz(mask);
+		}
+
+		return scan_bytes<Match>(i, end, set);
+	}
+
+	// As `scan_bytes`, but checking 32 bytes at a time.
+	template <bool Match>
+	__attribute__((target("avx2")))
+	const char * scan_avx2(const char * begin, const char * end,
+		const char_set & set)
+	{
+		auto chars = set.chars();
+		if (chars.empty()) return Match ? end : begin;
+
+		__m256i needles[char_set::capacity];
+
+		for (std::size_t k = 0; k < chars.size(); ++k) {
+			needles[k] = _mm256_set1_epi8(chars[k]);
+		}
+
+		auto i = begin;
+
+		for (; end - i >= 32; i += 32) {
+			auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(i));
+			auto matches = _mm256_cmpeq_epi8(block, needles[0]);
+
+			for (std::size_t k = 1; k < chars.size(); ++k) {
+				matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(block, needles[k]));
+			}
+
+			auto mask = static_cast<unsigned>(_mm256_movemask_epi8(matches));
+			if constexpr (!Match) mask = ~mask;
+
+			if (mask != 0) return i + __builtin_ctz(mask);
+		}
+
+		return scan_sse2<Match>(i, end, set);
+	}
+
+	template <bool Match>
+	scanner choose_scanner() {
+		__builtin_cpu_init();
+
+		if (__builtin_cpu_supports("avx2")) {
+			return scan_avx2<Match>;
+		} else {
+			return scan_sse2<Match>;
+		}
+	}
+#else
+	template <bool Match>
+	scanner choose_scanner() {
+		return scan_bytes<Match>;
+	}
+#endif
+}
+
+
+auto maf::_text_scan_impl::find_first_of(string_view::iterator begin,
+	string_view::iterator end, const char_set & set) -> string_view::iterator
+{
+	static const scanner scan = choose_scanner<true>();
+
+	auto first = std::to_address(begin);
+	auto found = scan(first, first + (end - begin), set);
+	return begin + (found - first);
+}
+
+
+auto maf::_text_scan_impl::find_first_not_of(string_view::iterator begin,
+	string_view::iterator end, const char_set & set) -> string_view::iterator
+{
+	// Runs of characters to be skipped, such as whitespace, are usually
+	// short, so check the first character before scanning any further.
+	if (begin == end || !set.contains(*begin)) return begin;
+
+	static const scanner scan = choose_scanner<false>();
+
+	auto first = std::to_address(begin);
+	auto found = scan(first + 1, first + (end - begin), set);
+	return begin + (found - first);
+}
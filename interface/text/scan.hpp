@@ -0,0 +1,56 @@
+#ifndef MAFIA_INTERFACE_TEXT_SCAN_H
+#define MAFIA_INTERFACE_TEXT_SCAN_H
+
+#include <array>
+#include <cstddef>
+
+#include "../../util/string.hpp"
+
+// Scanners used by the text engines to skip over plain text quickly.
+//
+// On x86-64, the scanners compare 16 or 32 bytes at a time using SSE2 or
+// AVX2, depending on what the processor supports. The choice is made the
+// first time that a scanner is used. Other platforms check one byte at a
+// time.
+namespace maf::_text_scan_impl {
+	// A set of at most 16 characters to scan for.
+	class char_set {
+	public:
+		static constexpr std::size_t capacity = 16;
+
+		// Create a set containing each character in `chars`.
+		//
+		// # Preconditions
+		// - `chars` has at most `capacity` characters.
+		constexpr char_set(string_view chars): _size{chars.size()} {
+			for (std::size_t i = 0; i < _size; ++i) _chars[i] = chars[i];
+		}
+
+		constexpr bool contains(char ch) const {
+			for (std::size_t i = 0; i < _size; ++i) {
+				if (_chars[i] == ch) return true;
+			}
+
+			return false;
+		}
+
+		// The characters in the set.
+		constexpr string_view chars() const { return {_chars.data(), _size}; }
+
+	private:
+		std::array<char, capacity> _chars{};
+		std::size_t _size;
+	};
+
+	// The first character in `{begin, end}` which is in `set`, or `end` if
+	// there is none.
+	string_view::iterator find_first_of(string_view::iterator begin,
+		string_view::iterator end, const char_set & set);
+
+	// The first character in `{begin, end}` which isn't in `set`, or `end`
+	// if there is none.
+	string_view::iterator find_first_not_of(string_view::iterator begin,
+		string_view::iterator end, const char_set & set);
+}
+
+#endif
@@ -60,8 +60,10 @@ using semantics_option = maf::StyledString::attributes_t::semantics_option;
 	NSMutableAttributedString *attributedString = [[NSMutableAttributedString alloc] init];
 	bool clearWhitespaceFromFront = false;
 
-	for (auto & styled_str : _console.output()) {
-		NSString *string = [NSString stringWithUTF8String:styled_str.str.c_str()];
+	for (auto styled_str : _console.output()) {
+		NSString *string = [[NSString alloc] initWithBytes:styled_str.str.data()
+		                                            length:styled_str.str.size()
+		                                          encoding:NSUTF8StringEncoding];
 
 		// Strip whitespace from front if last style was "title".
 		if (clearWhitespaceFromFront) {
@@ -130,8 +132,10 @@ using semantics_option = maf::StyledString::attributes_t::semantics_option;
 	NSMutableString *informativeText = [NSMutableString string];
 	bool clearWhitespaceFromFront = false;
 
-	for (auto & styled_str : _console.error_message()) {
-		NSString *string = [NSString stringWithUTF8String:styled_str.str.c_str()];
+	for (auto styled_str : _console.error_message()) {
+		NSString *string = [[NSString alloc] initWithBytes:styled_str.str.data()
+		                                            length:styled_str.str.size()
+		                                          encoding:NSUTF8StringEncoding];
 		auto attributes = styled_str.attributes;
 
 		// Strip whitespace from front if last style was "title".
@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+#include "../util/algorithm.hpp"
+
+#include "inference_check.hpp"
+
+namespace maf::sim::_enumerate_roles_impl {
+	using core::Ability;
+	using core::Public_info;
+
+	// The stream used to decide which information is made public.
+	constexpr std::uint32_t publish_stream = Random_streams::num_purposes;
+
+	// A card which could be dealt to a player.
+	struct card {
+		// `true` for a wildcard, `false` for a rolecard.
+		bool is_wildcard;
+		Role::ID role_id{};
+		Wildcard::ID wildcard_id{};
+
+		bool operator==(const card &) const = default;
+		auto operator<=>(const card &) const = default;
+	};
+
+	// Sums up the weight of every deal consistent with some public info.
+	struct enumeration {
+		const Public_info & info;
+		const Rulebook & rulebook;
+		// The roles in the rulebook.
+		vector_of_refs<const Role> roles;
+		// The roles that each card could end up as, together with their
+		// probabilities.
+		std::map<card, vector<pair<std::size_t, double>>> choices{};
+		// The cards dealt to each player in the current deal.
+		vector<card> deal{};
+		// The index of the role picked for each player in the current deal.
+		vector<std::size_t> picked{};
+		// Indexed by `player * roles.size() + role`.
+		vector<double> weights{};
+		double total{0.0};
+
+		std::size_t role_index(Role::ID id) const {
+			for (std::size_t r = 0; r < roles.size(); ++r) {
+				if (roles[r].get().id() == id) return r;
+			}
+
+			throw Rulebook::Missing_role_ID{id};
+		}
+
+		// Whether `player` could have the role with index `r`, going by the
+		// revealed roles and the results showing players to be innocent.
+		// Suspicious results are only checked once every role is picked,
+		// since they don't count if anybody could be peddling drugs.
+		bool allowed(std::size_t p, std::size_t r) const {
+			const Role & role = roles[r];
+
+			if (p < info.revealed_roles.size()) {
+				auto& revealed = info.revealed_roles[p];
+				if (revealed && role.id() != *revealed) return false;
+			}
+
+			return !role.is_suspicious() || util::none_of(info.investigations,
+				[&](const core::Published_investigation & investigation) {
+					return static_cast<std::size_t>(investigation.target) == p
+						&& !investigation.result;
+				});
+		}
+
+		// Whether the suspicious results are consistent with the roles
+		// picked for every player.
+		bool consistent() const {
+			bool any_peddlers = util::any_of(picked, [&](std::size_t r) {
+				return roles[r].get().has_ability(Ability::ID::peddle);
+			});
+			if (any_peddlers) return true;
+
+			return util::all_of(info.investigations,
+				[&](const core::Published_investigation & investigation) {
+					auto p = static_cast<std::size_t>(investigation.target);
+					return !investigation.result || roles[picked[p]].get().is_suspicious();
+				});
+		}
+
+		// Pick a role for each player from `p` onwards, given that the
+		// players before `p` were picked with probability `weight`.
+		void pick_roles(std::size_t p, double weight) {
+			if (p == deal.size()) {
+				if (!consistent()) return;
+
+				total += weight;
+				for (std::size_t q = 0; q < deal.size(); ++q) {
+					weights[q * roles.size() + picked[q]] += weight;
+				}
+
+				return;
+			}
+
+			for (auto [r, prob]: choices.at(deal[p])) {
+				picked[p] = r;
+				if (allowed(p, r)) pick_roles(p + 1, weight * prob);
+			}
+		}
+	};
+}
+
+maf::vector<double> maf::sim::enumerate_roles(const core::Public_info & info,
+                                              const Rulebook & rulebook)
+{
+	using namespace _enumerate_roles_impl;
+
+	enumeration e{info, rulebook, rulebook.roles()};
+
+	for (auto id: info.role_ids) {
+		e.deal.push_back({false, id, {}});
+	}
+	for (auto id: info.wildcard_ids) {
+		e.deal.push_back({true, {}, id});
+	}
+
+	for (auto& c: e.deal) {
+		auto& choices = e.choices[c];
+		if (!choices.empty()) continue;
+
+		if (c.is_wildcard) {
+			auto& wildcard = rulebook.get_wildcard(c.wildcard_id);
+			for (auto [id, prob]: wildcard.role_probabilities(rulebook)) {
+				choices.emplace_back(e.role_index(id), prob);
+			}
+		} else {
+			choices.emplace_back(e.role_index(c.role_id), 1.0);
+		}
+	}
+
+	e.picked.resize(e.deal.size());
+	e.weights.assign(e.deal.size() * e.roles.size(), 0.0);
+
+	// Every distinct ordering of the cards is equally likely to be dealt.
+	std::sort(e.deal.begin(), e.deal.end());
+	do {
+		e.pick_roles(0, 1.0);
+	} while (std::next_permutation(e.deal.begin(), e.deal.end()));
+
+	if (!(e.total > 0.0)) return {};
+
+	for (auto& weight: e.weights) weight /= e.total;
+	return e.weights;
+}
+
+double maf::sim::check_inference(const Setup & setup,
+                                 const Rulebook & rulebook,
+                                 Random_streams::Seed seed)
+{
+	using namespace _enumerate_roles_impl;
+
+	core::Game game{setup.role_ids, setup.wildcard_ids, rulebook, seed};
+	auto generator = Random_streams::make_generator(seed, publish_stream);
+
+	// Reveal roughly a quarter of the roles, and publish the correct
+	// investigation result for roughly a third of the players.
+	Public_info info{setup.role_ids, setup.wildcard_ids};
+	std::bernoulli_distribution reveal{0.25};
+	std::bernoulli_distribution publish{1.0 / 3.0};
+
+	for (const core::Player & player: game.players()) {
+		if (reveal(generator)) info.reveal_role(player.id(), player.role().id());
+		if (publish(generator)) {
+			info.investigations.push_back({player.id(), player.role().is_suspicious()});
+		}
+	}
+
+	auto expected = enumerate_roles(info, rulebook);
+	auto posterior = core::infer_roles(info, rulebook);
+	auto roles = rulebook.roles();
+
+	double max_difference = 0.0;
+
+	for (std::size_t p = 0; p < info.num_players(); ++p) {
+		for (std::size_t r = 0; r < roles.size(); ++r) {
+			auto id = static_cast<core::Player::ID>(p);
+			auto prob = posterior.probability(id, roles[r].get().id());
+			auto difference = std::abs(prob - expected[p * roles.size() + r]);
+			max_difference = std::max(max_difference, difference);
+		}
+	}
+
+	return max_difference;
+}
@@ -0,0 +1,37 @@
+#ifndef MAFIA_SIM_INFERENCE_CHECK_H
+#define MAFIA_SIM_INFERENCE_CHECK_H
+
+#include "../core/inference.hpp"
+
+#include "simulation.hpp"
+
+namespace maf::sim {
+	/// The largest number of players in a setup for which every deal can be
+	/// enumerated when checking role inference.
+	constexpr std::size_t max_players_for_enumeration = 8;
+
+	/// Infer the role of each player from `info`, by enumerating every deal
+	/// of the cards in `info` and every role that its wildcards could pick.
+	///
+	/// This gives the same result as `core::infer_roles`, but takes time
+	/// proportional to the number of deals. It's only meant for checking
+	/// `core::infer_roles` on small setups.
+	///
+	/// @returns The probability of each player having each role in
+	/// `rulebook`, indexed by `player * num_roles + role`, or an empty
+	/// vector if `info` is inconsistent.
+	vector<double> enumerate_roles(const core::Public_info & info,
+	                               const Rulebook & rulebook);
+
+	/// Deal a game of `setup` with `seed`, make some of the roles and
+	/// investigation results public at random, and infer the roles of the
+	/// players both with `core::infer_roles` and with `enumerate_roles`.
+	///
+	/// @returns The largest difference between the two probabilities of
+	/// any player having any role.
+	double check_inference(const Setup & setup,
+	                       const Rulebook & rulebook,
+	                       Random_streams::Seed seed);
+}
+
+#endif
@@ -0,0 +1,322 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+#include "../util/iostream.hpp"
+#include "../util/parse.hpp"
+#include "../util/string.hpp"
+
+#include "inference_check.hpp"
+#include "sweep.hpp"
+
+namespace maf::sim {
+	const char usage[] =
+		"usage: mafia-sim [options] [card ...]\n"
+		"\n"
+		"Simulate every setup for a given number of players, built from the\n"
+		"listed role and wildcard aliases (or every card in the rulebook if\n"
+		"none are given), and print the proportion of games won by each side.\n"
+		"\n"
+		"options:\n"
+		"  -n <count>    number of players in each setup (default: 5)\n"
+		"  -g <count>    most games to simulate per setup (default: 1000)\n"
+		"  -s <rule>     when to stop simulating a setup early, one of:\n"
+		"                  fixed        never stop early (default)\n"
+		"                  ci:<width>   once the 95% confidence interval of the\n"
+		"                               village's win rate is within +/-width\n"
+		"                  sprt:<d>     once an SPRT shows the village's win rate\n"
+		"                               is above 0.5+d or below 0.5-d\n"
+		"  -b <count>    most games to simulate in total (default: no limit)\n"
+		"  -a            give more games to setups whose win rate could be\n"
+		"                close to 50%, and list the closest setups first\n"
+		"                (can't be combined with -s sprt:<d>)\n"
+		"  -j <count>    number of threads to use (default: all cores)\n"
+		"  -r <seed>     play the nth game of every setup with the same seed\n"
+		"  -x <a> <b>    instead of sweeping, compare two setups written as\n"
+		"                comma-separated cards, e.g. peasant,peasant,godfather,\n"
+		"                by playing pairs of games with the same seed\n"
+		"  -i <setup>    instead of sweeping, check the roles inferred from\n"
+		"                random public info about -g deals of a setup of\n"
+		"                at most 8 cards against every possible deal\n"
+		"  -c <path>     file to cache results in (default: build/sim-cache.txt)\n"
+		"  -C            don't read or write a cache file\n";
+
+	// Parse a positive integer from a command-line argument.
+	bool parse_count(string_view arg, std::size_t & count) {
+		int value;
+		auto [ptr, ec] = util::from_chars(arg, value);
+		if (ec != std::errc{} || ptr != arg.data() + arg.size() || value <= 0) {
+			return false;
+		}
+
+		count = static_cast<std::size_t>(value);
+		return true;
+	}
+
+	// Parse a setup written as a comma-separated list of card aliases.
+	optional<Setup> parse_setup(string_view str, const Rulebook & rulebook) {
+		Setup setup{};
+
+		while (!str.empty()) {
+			auto comma = str.find(',');
+			auto alias = str.substr(0, comma);
+
+			if (rulebook.contains(alias)) {
+				setup.role_ids.push_back(rulebook.look_up(alias).id());
+			} else if (rulebook.contains_wildcard(alias)) {
+				setup.wildcard_ids.push_back(rulebook.get_wildcard(alias).id());
+			} else {
+				return std::nullopt;
+			}
+
+			str = (comma == string_view::npos) ? string_view{} : str.substr(comma + 1);
+		}
+
+		return setup;
+	}
+
+	// Play `num_games` pairs of games with the two setups, and print the
+	// difference in the village's win rate.
+	void print_comparison(const Setup & first, const Setup & second,
+	                      const Rulebook & rulebook, const Sweep_options & options)
+	{
+		auto seed = options.common_seed.value_or(Random_streams::random_seed());
+		auto num_games = options.max_games_per_setup;
+		auto comparison = compare(first, options.bot_options, second,
+			options.bot_options, rulebook, num_games, seed);
+
+		std::cout << "Played " << num_games << " pairs of games with seed "
+		          << seed << ".\n"
+		          << std::fixed << std::setprecision(1)
+		          << std::setw(8) << 100.0 * comparison.first.village_win_rate()
+		          << "%  " << canonical_key(first, rulebook) << '\n'
+		          << std::setw(8) << 100.0 * comparison.second.village_win_rate()
+		          << "%  " << canonical_key(second, rulebook) << '\n'
+		          << std::showpos
+		          << std::setw(8) << 100.0 * comparison.mean_difference
+		          << std::noshowpos
+		          << "%  difference, +/- " << 196.0 * comparison.std_error
+		          << "% (95% confidence)\n";
+	}
+
+	// Check role inference against enumeration for `num_games` deals of
+	// `setup`, and print the largest difference found.
+	//
+	// Returns `false` if any difference is too large to be rounding error.
+	bool print_inference_check(const Setup & setup, const Rulebook & rulebook,
+	                           const Sweep_options & options)
+	{
+		auto seed = options.common_seed.value_or(Random_streams::random_seed());
+		auto num_games = options.max_games_per_setup;
+
+		double max_difference = 0.0;
+		for (std::size_t n = 0; n < num_games; ++n) {
+			auto difference = check_inference(setup, rulebook, game_seed(seed, n));
+			max_difference = std::max(max_difference, difference);
+		}
+
+		std::cout << "Checked role inference for " << num_games
+		          << " deals of " << canonical_key(setup, rulebook)
+		          << " with seed " << seed << ".\n"
+		          << "Largest difference from enumerating every deal: "
+		          << max_difference << '\n';
+
+		return max_difference < 1e-9;
+	}
+
+	int run(int argc, char * argv[]) {
+		Rulebook rulebook{};
+		Sweep_options options{};
+		std::size_t num_players = 5;
+		fs::path cache_path = application::root_dir() / "build" / "sim-cache.txt";
+		bool use_cache = true;
+		optional<pair<Setup, Setup>> comparison{};
+		optional<Setup> inference_setup{};
+
+		vector<Role::ID> role_ids{};
+		vector<Wildcard::ID> wildcard_ids{};
+
+		for (int i = 1; i < argc; ++i) {
+			string_view arg = argv[i];
+
+			auto next_count = [&](std::size_t & count) {
+				if (i + 1 < argc && parse_count(argv[i + 1], count)) {
+					++i;
+					return true;
+				} else {
+					std::cerr << "Expected a positive number after " << arg << ".\n";
+					return false;
+				}
+			};
+
+			if (arg == "-h" || arg == "--help") {
+				std::cout << usage;
+				return 0;
+			} else if (arg == "-n") {
+				if (!next_count(num_players)) return 1;
+			} else if (arg == "-g") {
+				if (!next_count(options.max_games_per_setup)) return 1;
+			} else if (arg == "-b") {
+				if (!next_count(options.game_budget)) return 1;
+			} else if (arg == "-a") {
+				options.allocation = Sweep_options::Allocation::adaptive;
+			} else if (arg == "-j") {
+				if (!next_count(options.num_threads)) return 1;
+			} else if (arg == "-s") {
+				auto criterion = (i + 1 < argc) ? parse_stop_criterion(argv[i + 1]) : std::nullopt;
+				if (!criterion) {
+					std::cerr << "Expected a stop rule after -s.\n\n" << usage;
+					return 1;
+				}
+
+				options.stop_criterion = *criterion;
+				++i;
+			} else if (arg == "-r") {
+				Random_streams::Seed seed;
+				auto parsed = (i + 1 < argc) && [&] {
+					string_view str = argv[i + 1];
+					auto [ptr, ec] = util::from_chars(str, seed);
+					return ec == std::errc{} && ptr == str.data() + str.size();
+				}();
+
+				if (!parsed) {
+					std::cerr << "Expected a seed after -r.\n";
+					return 1;
+				}
+
+				options.common_seed = seed;
+				++i;
+			} else if (arg == "-x") {
+				auto first = (i + 1 < argc) ? parse_setup(argv[i + 1], rulebook) : std::nullopt;
+				auto second = (i + 2 < argc) ? parse_setup(argv[i + 2], rulebook) : std::nullopt;
+
+				if (!first || !second) {
+					std::cerr << "Expected two setups after -x.\n\n" << usage;
+					return 1;
+				}
+
+				comparison = {*first, *second};
+				i += 2;
+			} else if (arg == "-i") {
+				inference_setup = (i + 1 < argc) ? parse_setup(argv[i + 1], rulebook) : std::nullopt;
+
+				if (!inference_setup || inference_setup->num_players() == 0
+					|| inference_setup->num_players() > max_players_for_enumeration)
+				{
+					std::cerr << "Expected a setup of 1 to "
+					          << max_players_for_enumeration << " cards after -i.\n\n"
+					          << usage;
+					return 1;
+				}
+
+				++i;
+			} else if (arg == "-c") {
+				if (i + 1 == argc) {
+					std::cerr << "Expected a path after -c.\n";
+					return 1;
+				}
+
+				cache_path = argv[++i];
+			} else if (arg == "-C") {
+				use_cache = false;
+			} else if (rulebook.contains(arg)) {
+				role_ids.push_back(rulebook.get_role(arg).id());
+			} else if (rulebook.contains_wildcard(arg)) {
+				wildcard_ids.push_back(rulebook.get_wildcard(arg).id());
+			} else {
+				std::cerr << "Unrecognised option or card: " << arg << "\n\n" << usage;
+				return 1;
+			}
+		}
+
+		// An SPRT only decides which side of 50% a setup's win rate is on,
+		// so it would stop the setups that adaptive allocation keeps
+		// refining as soon as it picked a side.
+		if (options.allocation == Sweep_options::Allocation::adaptive
+			&& options.stop_criterion.kind == Stop_criterion::Kind::sprt)
+		{
+			std::cerr << "The SPRT stop rule can't be combined with -a.\n\n" << usage;
+			return 1;
+		}
+
+		if (comparison) {
+			print_comparison(comparison->first, comparison->second, rulebook, options);
+			return 0;
+		}
+
+		if (inference_setup) {
+			return print_inference_check(*inference_setup, rulebook, options) ? 0 : 1;
+		}
+
+		if (role_ids.empty() && wildcard_ids.empty()) {
+			for (const Role & role: rulebook.roles()) role_ids.push_back(role.id());
+			for (const Wildcard & wildcard: rulebook.wildcards()) wildcard_ids.push_back(wildcard.id());
+		}
+
+		auto setups = enumerate_setups(num_players, role_ids, wildcard_ids);
+
+		Result_cache cache{};
+		try {
+			if (use_cache) cache = Result_cache{cache_path};
+		} catch (const Result_cache::Bad_file & error) {
+			std::cerr << "Couldn't read the cache file " << error.path;
+			if (error.line > 0) std::cerr << " (line " << error.line << ")";
+			std::cerr << ".\n";
+			return 1;
+		}
+
+		std::cerr << "Simulating up to " << options.max_games_per_setup
+		          << " games per setup, stopping by "
+		          << describe(options.stop_criterion) << ".\n";
+
+		auto results = run_sweep(setups, rulebook, options, cache);
+
+		if (options.allocation == Sweep_options::Allocation::adaptive) {
+			auto distance = [&](const Sweep_result & result) {
+				return std::abs(result.tally.village_win_rate() - options.target);
+			};
+
+			std::stable_sort(results.begin(), results.end(),
+				[&](const Sweep_result & r1, const Sweep_result & r2) {
+					return distance(r1) < distance(r2);
+				});
+		}
+
+		std::size_t num_cached = 0;
+		std::cout << std::fixed << std::setprecision(1)
+		          << std::setw(9) << "village" << std::setw(9) << "mafia"
+		          << std::setw(9) << "unfin." << std::setw(9) << "games"
+		          << std::setw(8) << "stop" << "  setup\n";
+
+		for (auto& result: results) {
+			auto& tally = result.tally;
+			if (tally.games == result.cached_games) ++num_cached;
+
+			auto unfinished_rate = (tally.games == 0) ? 0.0
+				: static_cast<double>(tally.unfinished) / tally.games;
+
+			std::cout << std::setw(8) << 100.0 * tally.village_win_rate() << '%'
+			          << std::setw(8) << 100.0 * tally.mafia_win_rate() << '%'
+			          << std::setw(8) << 100.0 * unfinished_rate << '%'
+			          << std::setw(9) << tally.games
+			          << std::setw(8) << describe(result.stop_reason)
+			          << "  " << result.key << '\n';
+		}
+
+		std::cerr << results.size() << " setups, of which " << num_cached
+		          << " were already cached.\n";
+
+		try {
+			cache.save();
+		} catch (const Result_cache::Bad_file & error) {
+			std::cerr << "Couldn't write the cache file " << error.path << ".\n";
+			return 1;
+		}
+
+		return 0;
+	}
+}
+
+int main(int argc, char * argv[]) {
+	return maf::sim::run(argc, argv);
+}
@@ -0,0 +1,324 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "../util/algorithm.hpp"
+
+#include "simulation.hpp"
+
+namespace maf::sim::_simulate_game_impl {
+	using core::Ability;
+	using core::Alignment;
+	using core::Game;
+	using core::Player;
+
+	// The stream used by the bots, which is separate from the game's own
+	// streams.
+	constexpr std::uint32_t bot_stream = Random_streams::num_purposes;
+
+	// Check if an event with probability `p` occurs.
+	inline bool trial(double p, std::default_random_engine & generator) {
+		return std::bernoulli_distribution{p}(generator);
+	}
+
+	// Pick a random player from `players`, or `nullptr` if it is empty.
+	inline const Player * pick(const vector_of_refs<const Player> & players,
+	                           std::default_random_engine & generator)
+	{
+		if (players.empty()) return nullptr;
+
+		std::uniform_int_distribution<std::size_t> dist{0, players.size() - 1};
+		return &players[dist(generator)].get();
+	}
+
+	// The players still present in `game` other than `player` for which
+	// `pred` is true.
+	template <typename Pred>
+	vector_of_refs<const Player> other_players(const Game & game,
+	                                           const Player & player,
+	                                           Pred pred)
+	{
+		using Players = vector_of_refs<const Player>;
+
+		return util::filter_into<Players>(game.players(), [&](const Player & other) {
+			return other.is_present() && other != player && pred(other);
+		});
+	}
+
+	inline vector_of_refs<const Player> other_players(const Game & game,
+	                                                  const Player & player)
+	{
+		return other_players(game, player, [](const Player &) { return true; });
+	}
+
+	inline void stage_duels(Game & game, const Bot_options & options,
+	                        std::default_random_engine & generator)
+	{
+		for (const Player & player: game.players()) {
+			if (game.ended()) return;
+			if (!player.is_present()) continue;
+			if (!player.role().has_ability(Ability::ID::duel)) continue;
+			if (!trial(options.duel_chance, generator)) continue;
+
+			if (auto target = pick(other_players(game, player), generator)) {
+				game.stage_duel(player.id(), target->id());
+			}
+		}
+	}
+
+	inline void hold_lynch(Game & game, const Bot_options & options,
+	                       std::default_random_engine & generator)
+	{
+		auto voters = game.remaining_players();
+		std::shuffle(voters.begin(), voters.end(), generator);
+
+		vector<std::size_t> votes(game.players().size(), 0);
+
+		for (const Player & voter: voters) {
+			auto can_vote_for = [&](const Player & target) {
+				return !(voter.alignment() == Alignment::mafia
+				         && target.alignment() == Alignment::mafia);
+			};
+
+			auto candidates = other_players(game, voter, can_vote_for);
+
+			const Player * favourite = nullptr;
+			for (const Player & candidate: candidates) {
+				auto n = votes[candidate.id()];
+				if (n > 0 && (!favourite || n > votes[favourite->id()])) {
+					favourite = &candidate;
+				}
+			}
+
+			auto target = (favourite && trial(options.bandwagon_chance, generator))
+				? favourite
+				: pick(candidates, generator);
+
+			if (target) {
+				game.cast_lynch_vote(voter.id(), target->id());
+				++votes[target->id()];
+			}
+		}
+
+		game.process_lynch_votes();
+	}
+
+	inline void play_day(Game & game, const Bot_options & options,
+	                     std::default_random_engine & generator)
+	{
+		stage_duels(game, options, generator);
+		if (game.ended()) return;
+
+		if (game.lynch_can_occur()) {
+			hold_lynch(game, options, generator);
+			if (game.ended()) return;
+		}
+
+		game.begin_night();
+	}
+
+	inline void use_ability(Game & game, const Player & caster, Ability ability,
+	                        std::default_random_engine & generator)
+	{
+		auto target = pick(other_players(game, caster), generator);
+
+		switch (ability.id) {
+		case Ability::ID::kill:
+			if (target) game.cast_kill(caster.id(), target->id());
+			else game.skip_kill(caster.id());
+			break;
+		case Ability::ID::heal:
+			if (target) game.cast_heal(caster.id(), target->id());
+			else game.skip_heal(caster.id());
+			break;
+		case Ability::ID::investigate:
+			if (target) game.cast_investigate(caster.id(), target->id());
+			else game.skip_investigate(caster.id());
+			break;
+		case Ability::ID::peddle:
+			if (target) game.cast_peddle(caster.id(), target->id());
+			else game.skip_peddle(caster.id());
+			break;
+		case Ability::ID::duel:
+			throw std::logic_error{"Duels cannot be used at night."};
+		}
+	}
+
+	inline void play_night(Game & game, std::default_random_engine & generator) {
+		auto roles = game.rulebook().roles();
+
+		for (const Player & player: game.players()) {
+			if (game.ended() || game.is_day()) return;
+
+			if (player.is_present() && player.is_role_faker() && !player.has_fake_role()) {
+				std::uniform_int_distribution<std::size_t> dist{0, roles.size() - 1};
+				const core::Role & fake_role = roles[dist(generator)];
+				game.choose_fake_role(player.id(), fake_role.id());
+			}
+		}
+
+		for (const Player & player: game.players()) {
+			while (!game.ended() && game.is_night()
+			       && !player.compulsory_abilities().empty())
+			{
+				use_ability(game, player, player.compulsory_abilities().front(), generator);
+			}
+		}
+
+		if (game.ended() || game.is_day()) return;
+
+		if (game.mafia_can_use_kill()) {
+			auto casters = game.remaining_players(Alignment::mafia);
+			auto caster = pick(casters, generator);
+			auto target = caster
+				? pick(other_players(game, *caster, [](const Player & player) {
+					return player.alignment() != Alignment::mafia;
+				}), generator)
+				: nullptr;
+
+			if (caster && target) {
+				game.cast_mafia_kill(caster->id(), target->id());
+			} else {
+				game.skip_mafia_kill();
+			}
+		}
+
+		if (!game.ended() && game.is_night()) {
+			throw std::logic_error{"A simulated night failed to end."};
+		}
+	}
+}
+
+namespace maf::sim {
+	Setup canonicalise(Setup setup) {
+		util::sort(setup.role_ids);
+		util::sort(setup.wildcard_ids);
+		return setup;
+	}
+
+	string canonical_key(const Setup & setup, const Rulebook & rulebook) {
+		string key = std::to_string(rulebook.edition());
+		key += ':';
+
+		bool first = true;
+		auto append = [&](string_view alias, std::size_t count) {
+			if (count == 0) return;
+			if (!first) key += ',';
+			key += alias;
+			key += '*';
+			key += std::to_string(count);
+			first = false;
+		};
+
+		for (const Role & role: rulebook.roles()) {
+			append(role.alias(), util::count(setup.role_ids, role.id()));
+		}
+
+		for (const Wildcard & wildcard: rulebook.wildcards()) {
+			append(wildcard.alias(), util::count(setup.wildcard_ids, wildcard.id()));
+		}
+
+		return key;
+	}
+
+	void Tally::add(const Outcome & outcome) {
+		++games;
+		if (!outcome.finished) ++unfinished;
+		if (outcome.village_won) ++village_wins;
+		if (outcome.mafia_won) ++mafia_wins;
+	}
+
+	Tally & Tally::operator+=(const Tally & other) {
+		games += other.games;
+		village_wins += other.village_wins;
+		mafia_wins += other.mafia_wins;
+		unfinished += other.unfinished;
+		return *this;
+	}
+
+	Outcome simulate_game(const Setup & setup,
+	                      const Rulebook & rulebook,
+	                      const Bot_options & options,
+	                      Random_streams::Seed seed)
+	{
+		using namespace _simulate_game_impl;
+
+		Game game{setup.role_ids, setup.wildcard_ids, rulebook, seed};
+		auto generator = Random_streams::make_generator(seed, bot_stream);
+
+		while (!game.ended() && game.date() <= options.max_days) {
+			if (game.is_day()) {
+				play_day(game, options, generator);
+			} else {
+				play_night(game, generator);
+			}
+		}
+
+		Outcome outcome{};
+		outcome.finished = game.ended();
+		outcome.length = game.date();
+
+		if (outcome.finished) {
+			for (const Player & player: game.players()) {
+				if (!player.has_won()) continue;
+
+				switch (player.alignment()) {
+				case Alignment::village:
+					outcome.village_won = true;
+					break;
+				case Alignment::mafia:
+					outcome.mafia_won = true;
+					break;
+				case Alignment::freelance:
+					break;
+				}
+			}
+		}
+
+		return outcome;
+	}
+
+	Random_streams::Seed game_seed(Random_streams::Seed seed, std::size_t n) {
+		// SplitMix64, so that nearby values of `n` give unrelated seeds.
+		auto z = seed + (n + 1) * 0x9e3779b97f4a7c15;
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+		return z ^ (z >> 31);
+	}
+
+	Paired_comparison compare(const Setup & first_setup,
+	                          const Bot_options & first_options,
+	                          const Setup & second_setup,
+	                          const Bot_options & second_options,
+	                          const Rulebook & rulebook,
+	                          std::size_t num_games,
+	                          Random_streams::Seed seed)
+	{
+		Paired_comparison comparison{};
+		double sum_sq = 0.0;
+
+		for (std::size_t n = 0; n < num_games; ++n) {
+			auto s = game_seed(seed, n);
+			auto first = simulate_game(first_setup, rulebook, first_options, s);
+			auto second = simulate_game(second_setup, rulebook, second_options, s);
+
+			comparison.first.add(first);
+			comparison.second.add(second);
+
+			double d = static_cast<double>(first.village_won) - static_cast<double>(second.village_won);
+			comparison.mean_difference += d;
+			sum_sq += d * d;
+		}
+
+		if (num_games > 0) {
+			auto n = static_cast<double>(num_games);
+			auto mean = comparison.mean_difference / n;
+			auto variance = (n > 1) ? (sum_sq - n * mean * mean) / (n - 1) : 0.0;
+
+			comparison.mean_difference = mean;
+			comparison.std_error = std::sqrt(std::max(variance, 0.0) / n);
+		}
+
+		return comparison;
+	}
+}
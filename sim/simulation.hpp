@@ -0,0 +1,140 @@
+#ifndef MAFIA_SIM_SIMULATION_H
+#define MAFIA_SIM_SIMULATION_H
+
+#include <random>
+
+#include "../util/misc.hpp"
+#include "../util/string.hpp"
+#include "../util/vector.hpp"
+
+#include "../core/game.hpp"
+
+namespace maf::sim {
+	using core::Date;
+	using core::Random_streams;
+	using core::Role;
+	using core::Rulebook;
+	using core::Wildcard;
+
+	/// The cards that a game is set up with.
+	struct Setup {
+		vector<Role::ID> role_ids{};
+		vector<Wildcard::ID> wildcard_ids{};
+
+		/// The number of players needed for the setup.
+		std::size_t num_players() const {
+			return role_ids.size() + wildcard_ids.size();
+		}
+	};
+
+	/// Sort the cards in `setup` by ID, so that setups containing the same
+	/// cards compare equal.
+	Setup canonicalise(Setup setup);
+
+	/// A string identifying `setup` when played with `rulebook`.
+	///
+	/// This consists of the rulebook's edition, followed by the number of
+	/// each card in the setup. For example, a setup with three peasants and
+	/// a godfather would be written as `1:peasant*3,godfather*1` under the
+	/// first edition of the rules.
+	///
+	/// Setups containing the same cards have the same key, regardless of
+	/// the order in which the cards are listed.
+	string canonical_key(const Setup & setup, const Rulebook & rulebook);
+
+	/// Options for the bots which play simulated games.
+	struct Bot_options {
+		/// The probability that a player votes for the current favourite to
+		/// be lynched, rather than for a random player.
+		double bandwagon_chance{0.6};
+		/// The probability that a player able to duel stages a duel on any
+		/// given day.
+		double duel_chance{0.2};
+		/// The number of days after which a game is abandoned.
+		Date max_days{30};
+	};
+
+	/// The result of a single simulated game.
+	struct Outcome {
+		/// Whether the game ended within the maximum number of days.
+		bool finished{false};
+		/// Whether any village-aligned player won.
+		bool village_won{false};
+		/// Whether any mafia-aligned player won.
+		bool mafia_won{false};
+		/// The date on which the game ended or was abandoned.
+		Date length{0};
+	};
+
+	/// The combined results of some simulated games.
+	struct Tally {
+		std::size_t games{0};
+		std::size_t village_wins{0};
+		std::size_t mafia_wins{0};
+		std::size_t unfinished{0};
+
+		/// Add the result of another game to the tally.
+		void add(const Outcome & outcome);
+
+		/// The proportion of games which the village won.
+		double village_win_rate() const {
+			return games == 0 ? 0.0 : static_cast<double>(village_wins) / games;
+		}
+
+		/// The proportion of games which the mafia won.
+		double mafia_win_rate() const {
+			return games == 0 ? 0.0 : static_cast<double>(mafia_wins) / games;
+		}
+
+		Tally & operator+=(const Tally & other);
+	};
+
+	/// Play a game set up with `setup` to completion, with every decision
+	/// made by a simple bot.
+	///
+	/// The bots don't try to deduce anything. Each day they pile onto the
+	/// most popular lynch target with some probability, mafia members never
+	/// vote against each other, and every night ability is used on a random
+	/// valid target.
+	///
+	/// The game and the bots draw random numbers from separate streams
+	/// created from `seed`, so that games with the same seed can be used as
+	/// common random numbers when comparing setups or bot options.
+	Outcome simulate_game(const Setup & setup,
+	                      const Rulebook & rulebook,
+	                      const Bot_options & options,
+	                      Random_streams::Seed seed);
+
+	/// The seed for the `n`th game in a series of games played with common
+	/// random numbers from `seed`.
+	Random_streams::Seed game_seed(Random_streams::Seed seed, std::size_t n);
+
+	/// The result of playing two variants of a game against each other,
+	/// using the same seed for each pair of games.
+	struct Paired_comparison {
+		Tally first{};
+		Tally second{};
+		/// The mean of the village's wins in the first variant minus its
+		/// wins in the second, over every pair of games.
+		double mean_difference{0.0};
+		/// The standard error of `mean_difference`.
+		double std_error{0.0};
+	};
+
+	/// Compare the village's win rate between two variants of a game, each
+	/// consisting of a setup and the options for its bots.
+	///
+	/// Each of the `num_games` pairs is played with the same seed, derived
+	/// from `seed`. Since most of the randomness is shared, the difference
+	/// between the variants has a much smaller standard error than if the
+	/// games were played independently.
+	Paired_comparison compare(const Setup & first_setup,
+	                          const Bot_options & first_options,
+	                          const Setup & second_setup,
+	                          const Bot_options & second_options,
+	                          const Rulebook & rulebook,
+	                          std::size_t num_games,
+	                          Random_streams::Seed seed);
+}
+
+#endif
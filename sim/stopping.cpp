@@ -0,0 +1,130 @@
+#include <cmath>
+#include <sstream>
+
+#include "../util/parse.hpp"
+
+#include "stopping.hpp"
+
+namespace maf::sim {
+	Stop_reason check_stop(const Stop_criterion & criterion,
+	                       const Tally & tally,
+	                       std::size_t max_games)
+	{
+		if (tally.games >= max_games) return Stop_reason::max_games;
+		if (tally.games < criterion.min_games) return Stop_reason::not_stopped;
+
+		switch (criterion.kind) {
+		case Stop_criterion::Kind::fixed:
+			return Stop_reason::not_stopped;
+
+		case Stop_criterion::Kind::ci_width: {
+			auto [lower, upper] = village_win_interval(tally, criterion.z);
+
+			if (upper - lower <= 2 * criterion.half_width) {
+				return Stop_reason::precise;
+			} else {
+				return Stop_reason::not_stopped;
+			}
+		}
+
+		case Stop_criterion::Kind::sprt: {
+			// Test H0: p = 0.5 - d against H1: p = 0.5 + d.
+			auto p0 = 0.5 - criterion.indifference;
+			auto p1 = 0.5 + criterion.indifference;
+			auto wins = static_cast<double>(tally.village_wins);
+			auto losses = static_cast<double>(tally.games - tally.village_wins);
+
+			auto llr = wins * std::log(p1 / p0) + losses * std::log((1 - p1) / (1 - p0));
+			auto upper = std::log((1 - criterion.beta) / criterion.alpha);
+			auto lower = std::log(criterion.beta / (1 - criterion.alpha));
+
+			if (llr >= upper) return Stop_reason::village_favoured;
+			if (llr <= lower) return Stop_reason::mafia_favoured;
+			return Stop_reason::not_stopped;
+		}
+		}
+
+		return Stop_reason::not_stopped;
+	}
+
+	pair<double, double> village_win_interval(const Tally & tally, double z) {
+		if (tally.games == 0) return {0.0, 1.0};
+
+		auto n = static_cast<double>(tally.games);
+		auto p = tally.village_win_rate();
+		auto z2 = z * z;
+
+		auto centre = (p + z2 / (2 * n)) / (1 + z2 / n);
+		auto spread = z * std::sqrt(p * (1 - p) / n + z2 / (4 * n * n)) / (1 + z2 / n);
+
+		return {centre - spread, centre + spread};
+	}
+
+	string describe(const Stop_criterion & criterion) {
+		std::ostringstream ss{};
+
+		switch (criterion.kind) {
+		case Stop_criterion::Kind::fixed:
+			ss << "fixed";
+			break;
+		case Stop_criterion::Kind::ci_width:
+			ss << "ci(+/-" << criterion.half_width << ", z=" << criterion.z << ")";
+			break;
+		case Stop_criterion::Kind::sprt:
+			ss << "sprt(0.5+/-" << criterion.indifference
+			   << ", a=" << criterion.alpha << ", b=" << criterion.beta << ")";
+			break;
+		}
+
+		if (criterion.kind != Stop_criterion::Kind::fixed) {
+			ss << " after " << criterion.min_games << " games";
+		}
+
+		return ss.str();
+	}
+
+	string_view describe(Stop_reason reason) {
+		switch (reason) {
+		case Stop_reason::not_stopped:
+			return "-";
+		case Stop_reason::max_games:
+			return "max";
+		case Stop_reason::out_of_budget:
+			return "budget";
+		case Stop_reason::precise:
+			return "ci";
+		case Stop_reason::village_favoured:
+			return "sprt:v";
+		case Stop_reason::mafia_favoured:
+			return "sprt:m";
+		}
+
+		return "?";
+	}
+
+	optional<Stop_criterion> parse_stop_criterion(string_view str) {
+		Stop_criterion criterion{};
+
+		auto colon = str.find(':');
+		auto name = str.substr(0, colon);
+		auto arg = (colon == string_view::npos) ? string_view{} : str.substr(colon + 1);
+
+		auto parse_fraction = [&](double & value) {
+			auto [ptr, ec] = util::from_chars(arg, value);
+			return ec == std::errc{} && ptr == arg.data() + arg.size()
+				&& value > 0.0 && value < 0.5;
+		};
+
+		if (name == "fixed" && colon == string_view::npos) {
+			criterion.kind = Stop_criterion::Kind::fixed;
+		} else if (name == "ci" && parse_fraction(criterion.half_width)) {
+			criterion.kind = Stop_criterion::Kind::ci_width;
+		} else if (name == "sprt" && parse_fraction(criterion.indifference)) {
+			criterion.kind = Stop_criterion::Kind::sprt;
+		} else {
+			return std::nullopt;
+		}
+
+		return criterion;
+	}
+}
@@ -0,0 +1,83 @@
+#ifndef MAFIA_SIM_STOPPING_H
+#define MAFIA_SIM_STOPPING_H
+
+#include "../util/optional.hpp"
+#include "../util/string.hpp"
+
+#include "simulation.hpp"
+
+namespace maf::sim {
+	/// A rule deciding when enough games of a setup have been simulated to
+	/// know how balanced it is.
+	///
+	/// Every criterion stops after `min_games` at the earliest, and after
+	/// the maximum number of games allowed by the sweep at the latest.
+	struct Stop_criterion {
+		enum class Kind {
+			/// Always simulate the maximum number of games.
+			fixed,
+			/// Stop once the confidence interval for the village's win rate
+			/// is narrower than `half_width` on either side.
+			ci_width,
+			/// Stop once a sequential probability ratio test can tell
+			/// whether the village's win rate is above `0.5 + indifference`
+			/// or below `0.5 - indifference`.
+			sprt
+		};
+
+		Kind kind{Kind::fixed};
+		/// The number of games to simulate before checking the criterion.
+		std::size_t min_games{100};
+		/// The number of standard deviations covered by a confidence
+		/// interval. `1.96` gives a 95% interval.
+		double z{1.96};
+		/// The target half-width of the confidence interval.
+		double half_width{0.02};
+		/// Win rates this close to 50% are treated as balanced by the SPRT.
+		double indifference{0.05};
+		/// The SPRT's chance of wrongly concluding that the village is
+		/// favoured.
+		double alpha{0.05};
+		/// The SPRT's chance of wrongly concluding that the mafia are
+		/// favoured.
+		double beta{0.05};
+	};
+
+	/// The reason that no more games of a setup were simulated.
+	enum class Stop_reason {
+		/// More games are still needed.
+		not_stopped,
+		/// The maximum number of games was simulated.
+		max_games,
+		/// The sweep ran out of games to give to the setup.
+		out_of_budget,
+		/// The win rate is known to within the target confidence interval.
+		precise,
+		/// The SPRT concluded that the village are favoured.
+		village_favoured,
+		/// The SPRT concluded that the mafia are favoured.
+		mafia_favoured
+	};
+
+	/// Check whether `tally` satisfies `criterion`, given that at most
+	/// `max_games` games can be simulated.
+	Stop_reason check_stop(const Stop_criterion & criterion,
+	                       const Tally & tally,
+	                       std::size_t max_games);
+
+	/// The Wilson score interval for the village's win rate in `tally`,
+	/// covering `z` standard deviations, as a pair of `{lower, upper}`.
+	pair<double, double> village_win_interval(const Tally & tally, double z);
+
+	/// A short description of `criterion`, e.g. `sprt(0.05, a=0.05, b=0.05)`.
+	string describe(const Stop_criterion & criterion);
+
+	/// A short label for `reason`, suitable for a column of a table.
+	string_view describe(Stop_reason reason);
+
+	/// Parse a stop criterion written as `fixed`, `ci:<half_width>` or
+	/// `sprt:<indifference>`, e.g. `ci:0.02`.
+	optional<Stop_criterion> parse_stop_criterion(string_view str);
+}
+
+#endif
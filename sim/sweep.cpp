@@ -0,0 +1,358 @@
+#include <atomic>
+#include <cmath>
+#include <future>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#include "../util/algorithm.hpp"
+#include "../util/fstream.hpp"
+
+#include "sweep.hpp"
+
+namespace maf::sim::_run_sweep_impl {
+	// The key under which the results for the setup with the given key are
+	// cached. Games played with a common seed are kept apart from games
+	// played with random seeds, and from games played with any other
+	// common seed, so that the `n`th cached game of a setup is always the
+	// one that a sweep with the same options would have played.
+	inline string cache_key(const string & key, const Sweep_options & options) {
+		if (!options.common_seed) return key;
+		return key + "@" + std::to_string(*options.common_seed);
+	}
+
+	// A number of games to be simulated for one of the setups in a sweep.
+	struct batch {
+		// The index of the setup in the sweep's results.
+		std::size_t result;
+		// The number of games of the setup started before this batch.
+		std::size_t first_game;
+		// The number of games to simulate.
+		std::size_t games;
+	};
+
+	// Hands out batches of games to the workers in a sweep, until every
+	// setup has met its stop criterion or the sweep's budget is used up.
+	//
+	// With sequential allocation, batches are handed out for one setup at a
+	// time, so that a setup's stop criterion can be met before batches are
+	// started for the next.
+	//
+	// With adaptive allocation, each setup first gets enough games to check
+	// its stop criterion. After that, the setups are treated as the arms of
+	// a thresholding bandit and the next batch goes to the setup with the
+	// smallest `sqrt(n) * (|p - target| + tolerance)`, where `n` is the
+	// number of games started and `p` the observed win rate. This is the
+	// APT rule of Locatelli et al. (2016): setups whose win rate is clearly
+	// far from the target soon stop getting games, while those close to it
+	// keep being refined.
+	class scheduler {
+	public:
+		scheduler(vector<Sweep_result> & results, const Sweep_options & options)
+		:
+			_results{results},
+			_options{options},
+			_scheduled(results.size()),
+			_new_tallies(results.size())
+		{
+			for (std::size_t i = 0; i < results.size(); ++i) {
+				_scheduled[i] = results[i].tally.games;
+				update_stop_reason(i);
+			}
+		}
+
+		// The next batch of games to simulate, or `nullopt` if there are
+		// none left.
+		optional<batch> next() {
+			using Allocation = Sweep_options::Allocation;
+
+			std::lock_guard lock{_mutex};
+
+			auto budget = _options.game_budget;
+			if (budget > 0 && _total_scheduled >= budget) return std::nullopt;
+
+			auto i = (_options.allocation == Allocation::adaptive)
+				? pick_adaptive()
+				: pick_sequential();
+
+			if (!i) return std::nullopt;
+
+			auto games = std::min(_options.max_games_per_setup - _scheduled[*i],
+			                      std::max<std::size_t>(_options.batch_size, 1));
+			if (budget > 0) games = std::min(games, budget - _total_scheduled);
+
+			batch b{*i, _scheduled[*i], games};
+			_scheduled[*i] += games;
+			_total_scheduled += games;
+
+			return b;
+		}
+
+		// Record the games played in a finished batch.
+		void finish(const batch & b, const Tally & tally) {
+			std::lock_guard lock{_mutex};
+
+			_results[b.result].tally += tally;
+			_new_tallies[b.result] += tally;
+			update_stop_reason(b.result);
+		}
+
+		// The games simulated for the `i`th setup since the sweep started.
+		const Tally & new_tally(std::size_t i) const {
+			return _new_tallies[i];
+		}
+
+		// Mark every setup which still needed games as having run out of
+		// budget. This should be called once every batch has finished.
+		void close() {
+			for (auto& result: _results) {
+				if (result.stop_reason == Stop_reason::not_stopped) {
+					result.stop_reason = Stop_reason::out_of_budget;
+				}
+			}
+		}
+
+	private:
+		vector<Sweep_result> & _results;
+		const Sweep_options & _options;
+		// The number of games started for each setup, including those
+		// loaded from the cache.
+		vector<std::size_t> _scheduled;
+		vector<Tally> _new_tallies;
+		std::size_t _total_scheduled{0};
+		// Every setup before this one has had all of its batches started
+		// (or with adaptive allocation, its initial batches).
+		std::size_t _cursor{0};
+		std::mutex _mutex{};
+
+		optional<std::size_t> pick_sequential() {
+			while (_cursor < _results.size() && !needs_games(_cursor)) ++_cursor;
+			if (_cursor == _results.size()) return std::nullopt;
+			return _cursor;
+		}
+
+		optional<std::size_t> pick_adaptive() {
+			auto min_games = _options.stop_criterion.min_games;
+
+			auto needs_initial_games = [&](std::size_t i) {
+				return needs_games(i) && _scheduled[i] < min_games;
+			};
+
+			while (_cursor < _results.size() && !needs_initial_games(_cursor)) ++_cursor;
+			if (_cursor < _results.size()) return _cursor;
+
+			optional<std::size_t> best{};
+			double best_score = 0.0;
+
+			for (std::size_t i = 0; i < _results.size(); ++i) {
+				if (!needs_games(i)) continue;
+
+				// Batches which haven't finished yet count towards `n`, so
+				// that workers don't all pile onto the same setup.
+				auto& tally = _results[i].tally;
+				auto p = (tally.games == 0) ? _options.target : tally.village_win_rate();
+				auto gap = std::abs(p - _options.target) + _options.tolerance;
+				auto score = std::sqrt(static_cast<double>(_scheduled[i])) * gap;
+
+				if (!best || score < best_score) {
+					best = i;
+					best_score = score;
+				}
+			}
+
+			return best;
+		}
+
+		bool needs_games(std::size_t i) const {
+			return _results[i].stop_reason == Stop_reason::not_stopped
+				&& _scheduled[i] < _options.max_games_per_setup;
+		}
+
+		void update_stop_reason(std::size_t i) {
+			auto& result = _results[i];
+
+			if (result.stop_reason == Stop_reason::not_stopped) {
+				result.stop_reason = check_stop(_options.stop_criterion,
+					result.tally, _options.max_games_per_setup);
+			}
+		}
+	};
+}
+
+namespace maf::sim {
+	vector<Setup> enumerate_setups(std::size_t num_players,
+	                               span<const Role::ID> role_ids,
+	                               span<const Wildcard::ID> wildcard_ids)
+	{
+		vector<Role::ID> roles(role_ids.begin(), role_ids.end());
+		util::sort(roles);
+		roles.erase(std::unique(roles.begin(), roles.end()), roles.end());
+
+		vector<Wildcard::ID> wildcards(wildcard_ids.begin(), wildcard_ids.end());
+		util::sort(wildcards);
+		wildcards.erase(std::unique(wildcards.begin(), wildcards.end()), wildcards.end());
+
+		auto num_kinds = roles.size() + wildcards.size();
+
+		vector<Setup> setups{};
+		Setup setup{};
+
+		// Choose how many copies of the `k`th kind of card to add to the
+		// setup, given that `left` more cards are needed. Cards are added in
+		// sorted order, so every setup produced is already canonical.
+		auto choose = [&](auto & self, std::size_t k, std::size_t left) -> void {
+			if (k == num_kinds) {
+				if (left == 0) setups.push_back(setup);
+				return;
+			}
+
+			for (std::size_t count = 0; count <= left; ++count) {
+				self(self, k + 1, left - count);
+
+				if (k < roles.size()) {
+					setup.role_ids.push_back(roles[k]);
+				} else {
+					setup.wildcard_ids.push_back(wildcards[k - roles.size()]);
+				}
+			}
+
+			for (std::size_t count = 0; count <= left; ++count) {
+				if (k < roles.size()) {
+					setup.role_ids.pop_back();
+				} else {
+					setup.wildcard_ids.pop_back();
+				}
+			}
+		};
+
+		choose(choose, 0, num_players);
+
+		return setups;
+	}
+
+	Result_cache::Result_cache(fs::path path) : _path{move(path)} {
+		using Reason = Bad_file::Reason;
+
+		if (!fs::exists(_path)) return;
+
+		ifstream input{_path};
+		if (!input) throw Bad_file{_path, Reason::cannot_open};
+
+		string line;
+		for (std::size_t line_num = 1; getline(input, line); ++line_num) {
+			if (line.empty() || line.front() == '#') continue;
+
+			std::istringstream fields{line};
+			string key;
+			Tally tally{};
+
+			fields >> key >> tally.games >> tally.village_wins
+			       >> tally.mafia_wins >> tally.unfinished;
+
+			if (!fields) throw Bad_file{_path, Reason::bad_line, line_num};
+
+			_results[key] += tally;
+		}
+	}
+
+	optional<Tally> Result_cache::find(const string & key) const {
+		auto iter = _results.find(key);
+		if (iter == _results.end()) return std::nullopt;
+		return iter->second;
+	}
+
+	void Result_cache::add(const string & key, const Tally & tally) {
+		_results[key] += tally;
+	}
+
+	void Result_cache::save() const {
+		using Reason = Bad_file::Reason;
+
+		if (_path.empty()) return;
+
+		// Write to a temporary file first, so that an interrupted save
+		// doesn't lose the existing results.
+		auto temp_path = _path;
+		temp_path += ".tmp";
+
+		{
+			ofstream output{temp_path};
+			if (!output) throw Bad_file{temp_path, Reason::cannot_open};
+
+			output << "# setup games village_wins mafia_wins unfinished\n";
+
+			for (auto& [key, tally]: _results) {
+				output << key << ' ' << tally.games << ' ' << tally.village_wins
+				       << ' ' << tally.mafia_wins << ' ' << tally.unfinished << '\n';
+			}
+
+			if (!output) throw Bad_file{temp_path, Reason::cannot_open};
+		}
+
+		fs::rename(temp_path, _path);
+	}
+
+	vector<Sweep_result> run_sweep(span<const Setup> setups,
+	                               const Rulebook & rulebook,
+	                               const Sweep_options & options,
+	                               Result_cache & cache)
+	{
+		using namespace _run_sweep_impl;
+
+		vector<Sweep_result> results{};
+		std::set<string> seen_keys{};
+
+		for (auto& setup: setups) {
+			auto canonical_setup = canonicalise(setup);
+			auto key = canonical_key(canonical_setup, rulebook);
+			if (seen_keys.contains(key)) continue;
+
+			auto tally = cache.find(cache_key(key, options)).value_or(Tally{});
+			seen_keys.insert(key);
+			results.push_back({move(canonical_setup), move(key), tally, tally.games});
+		}
+
+		scheduler batches{results, options};
+
+		auto work = [&] {
+			std::mt19937_64 seeds{Random_streams::random_seed()};
+
+			while (auto b = batches.next()) {
+				auto& setup = results[b->result].setup;
+				Tally tally{};
+
+				for (std::size_t n = 0; n < b->games; ++n) {
+					auto seed = options.common_seed
+						? game_seed(*options.common_seed, b->first_game + n)
+						: seeds();
+
+					tally.add(simulate_game(setup, rulebook, options.bot_options, seed));
+				}
+
+				batches.finish(*b, tally);
+			}
+		};
+
+		auto num_threads = options.num_threads;
+		if (num_threads == 0) num_threads = std::thread::hardware_concurrency();
+		num_threads = std::max<std::size_t>(num_threads, 1);
+
+		vector<std::future<void>> workers{};
+		for (std::size_t t = 1; t < num_threads; ++t) {
+			workers.push_back(std::async(std::launch::async, work));
+		}
+
+		work();
+		for (auto& worker: workers) worker.get();
+
+		batches.close();
+
+		for (std::size_t i = 0; i < results.size(); ++i) {
+			auto& new_tally = batches.new_tally(i);
+			if (new_tally.games > 0) cache.add(cache_key(results[i].key, options), new_tally);
+		}
+
+		return results;
+	}
+}
@@ -0,0 +1,144 @@
+#ifndef MAFIA_SIM_SWEEP_H
+#define MAFIA_SIM_SWEEP_H
+
+#include <map>
+
+#include "../util/filesystem.hpp"
+#include "../util/optional.hpp"
+#include "../util/span.hpp"
+
+#include "simulation.hpp"
+#include "stopping.hpp"
+
+namespace maf::sim {
+	/// Every setup for `num_players` players which can be made from the
+	/// given rolecards and wildcards, where any card may be used more than
+	/// once.
+	///
+	/// Each setup is canonical and appears exactly once, even if the same
+	/// card is listed more than once in `role_ids` or `wildcard_ids`.
+	vector<Setup> enumerate_setups(std::size_t num_players,
+	                               span<const Role::ID> role_ids,
+	                               span<const Wildcard::ID> wildcard_ids);
+
+	/// Results of previous sweeps, stored on disk.
+	///
+	/// Each result is keyed by `canonical_key`, so that results obtained
+	/// under an old edition of the rules are never reused. The key may be
+	/// followed by `@` and a seed, for games played with common random
+	/// numbers.
+	class Result_cache {
+	public:
+		/// Signifies that a cache file could not be read or written.
+		struct Bad_file {
+			enum class Reason {
+				cannot_open,
+				bad_line
+			};
+
+			fs::path path;
+			Reason reason;
+			/// The line number at which the error occurred, if relevant.
+			std::size_t line{0};
+		};
+
+		/// Create an empty cache, which isn't backed by any file.
+		Result_cache() = default;
+
+		/// Load the cache stored at `path`. If no file exists there yet,
+		/// the cache starts off empty.
+		///
+		/// @throws `Bad_file` if the file exists but could not be parsed.
+		explicit Result_cache(fs::path path);
+
+		/// The cached results for the setup with the given key, if any.
+		optional<Tally> find(const string & key) const;
+
+		/// Add `tally` to the results stored for the setup with the given
+		/// key.
+		void add(const string & key, const Tally & tally);
+
+		/// Write the cache back to the file that it was loaded from. Does
+		/// nothing if the cache isn't backed by a file.
+		///
+		/// @throws `Bad_file` if the file could not be written.
+		void save() const;
+
+	private:
+		fs::path _path{};
+		std::map<string, Tally> _results{};
+	};
+
+	/// Options controlling how a sweep is run.
+	struct Sweep_options {
+		/// How games are shared out between the setups in a sweep.
+		enum class Allocation {
+			/// Simulate each setup in turn until it meets its stop
+			/// criterion.
+			sequential,
+			/// Once every setup has been simulated enough to estimate its
+			/// win rate, keep giving more games to the setups which could
+			/// still be close to `target`.
+			adaptive
+		};
+
+		Allocation allocation{Allocation::sequential};
+		/// The total number of new games to simulate in the sweep, or zero
+		/// for no limit.
+		std::size_t game_budget{0};
+		/// The village win rate sought by adaptive allocation.
+		double target{0.5};
+		/// Win rates this close to `target` are treated as equally good by
+		/// adaptive allocation.
+		double tolerance{0.02};
+		/// The largest number of games to simulate for each setup.
+		std::size_t max_games_per_setup{1000};
+		/// The rule deciding whether a setup needs any more games.
+		Stop_criterion stop_criterion{};
+		/// The number of games simulated as a single unit of work.
+		std::size_t batch_size{100};
+		/// If set, the `n`th game of every setup is played with the seed
+		/// `game_seed(*common_seed, n)`, so that differences between setups
+		/// aren't drowned out by differences in luck.
+		optional<Random_streams::Seed> common_seed{};
+		/// The number of threads to run simulations on, or zero to use
+		/// every available core.
+		std::size_t num_threads{0};
+		/// Options for the bots playing each game.
+		Bot_options bot_options{};
+	};
+
+	/// The result of sweeping over a single setup.
+	struct Sweep_result {
+		Setup setup;
+		string key;
+		Tally tally;
+		/// The number of games which had already been simulated in a
+		/// previous sweep.
+		std::size_t cached_games;
+		/// The reason that no more games were simulated.
+		Stop_reason stop_reason{Stop_reason::not_stopped};
+	};
+
+	/// Simulate games for each of `setups`, spreading batches of games over
+	/// multiple threads.
+	///
+	/// Each setup's stop criterion is checked whenever a batch of its games
+	/// finishes, and no more batches are started once it has been met. The
+	/// order in which setups get their batches is decided by
+	/// `options.allocation`.
+	///
+	/// Results found in `cache` are reused, so that only the games which
+	/// haven't been simulated before are played. The new results are then
+	/// added to `cache`, which is left for the caller to save. Games played
+	/// with `options.common_seed` are cached separately for each seed.
+	///
+	/// Duplicate setups are only simulated once, and appear once in the
+	/// returned results.
+	vector<Sweep_result> run_sweep(span<const Setup> setups,
+	                               const Rulebook & rulebook,
+	                               const Sweep_options & options,
+	                               Result_cache & cache);
+}
+
+#endif
@@ -0,0 +1,272 @@
+// Collect the text resources used by the application, either as a C++
+// source file to be compiled into the executable or as a resource pack to
+// be mapped into memory at run-time. The templates among them can also be
+// compiled into C++ functions.
+//
+// # Usage
+// ```
+// embed_resources [--pack | --templates] <resources-dir> <output-file>
+// ```
+// Every ".txt" file below `<resources-dir>/txt` is collected, keyed by its
+// path relative to `<resources-dir>` and sorted by path, so that it can be
+// found with a binary search.
+//
+// By default, `<output-file>` is a C++ source file defining the resources
+// as entries in `maf::_resources_impl::embedded_resources`. With `--pack`,
+// it's a resource pack in the format described in
+// `interface/resources.hpp`.
+//
+// With `--templates`, `<output-file>` is a C++ source file defining a
+// function for each resource, which renders it as a template. These are
+// listed in `maf::_compiled_template_impl::compiled_templates`. If any
+// template can't be parsed, the error is reported and nothing is written.
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../interface/format.hpp"
+#include "../interface/resources.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+	struct resource {
+		std::string path;
+		std::string contents;
+	};
+
+	std::string read_all(const fs::path & path) {
+		std::ifstream input{path, std::ios::binary};
+
+		if (!input) {
+			throw std::runtime_error{"cannot read " + path.string()};
+		}
+
+		std::istreambuf_iterator<char> input_iter{input}, eos{};
+		return {input_iter, eos};
+	}
+
+	// Write `str` as a sequence of adjacent string literals, one for each
+	// line of `str`.
+	void write_literal(std::ostream & out, std::string_view str) {
+		out << "\n\t\t\"";
+
+		for (auto ch: str) {
+			switch (ch) {
+			case '"':  out << "\\\""; break;
+			case '\\': out << "\\\\"; break;
+			case '\t': out << "\\t"; break;
+			case '\n': out << "\\n\"\n\t\t\""; break;
+
+			default:
+				if (ch >= ' ' && ch <= '~') {
+					out << ch;
+				} else {
+					// Octal escapes are at most three digits long, so they
+					// can't swallow any characters that come after them.
+					auto byte = static_cast<unsigned char>(ch);
+					out << '\\'
+						<< static_cast<char>('0' + (byte >> 6))
+						<< static_cast<char>('0' + ((byte >> 3) & 7))
+						<< static_cast<char>('0' + (byte & 7));
+				}
+			}
+		}
+
+		out << "\"sv";
+	}
+
+	void write_source(std::ostream & out, const std::vector<resource> & resources) {
+		out << "// Generated by tools/embed_resources.cpp. Do not edit.\n\n";
+		out << "#include \"../../interface/resources.hpp\"\n\n";
+		out << "namespace maf::_resources_impl {\n";
+		out << "\tusing namespace std::literals;\n\n";
+		out << "\tconst embedded_resource embedded_resources[] = {\n";
+
+		for (auto & res: resources) {
+			out << "\t\t{\"" << res.path << "\"sv,";
+			write_literal(out, res.contents);
+			out << "},\n";
+		}
+
+		out << "\t};\n\n";
+		out << "\tconst std::size_t num_embedded_resources = " << resources.size() << ";\n";
+		out << "}\n";
+	}
+
+	// Write a function rendering each resource as a template.
+	//
+	// # Exceptions
+	// - Throws `std::runtime_error` if any of the templates can't be parsed.
+	void write_templates(std::ostream & out, const std::vector<resource> & resources) {
+		std::vector<maf::TextTemplate> templates;
+
+		for (auto & res: resources) {
+			try {
+				templates.emplace_back(res.contents);
+			} catch (const maf::preprocess_text_error & error) {
+				// Report the line and column of the error, like a compiler.
+				auto before = res.contents.substr(0, error.pos());
+				auto line = std::count(before.begin(), before.end(), '\n') + 1;
+				auto column = before.size() - before.find_last_of('\n');
+
+				throw std::runtime_error{"resources/" + res.path + ":"
+					+ std::to_string(line) + ":" + std::to_string(column) + ": "
+					+ error.message()};
+			}
+		}
+
+		out << "// Generated by tools/embed_resources.cpp. Do not edit.\n\n";
+		out << "#include <array>\n\n";
+		out << "#include \"../../interface/text/compiled.hpp\"\n\n";
+		out << "namespace maf::_compiled_template_impl {\n";
+		out << "\tusing namespace std::literals;\n";
+
+		for (std::size_t i = 0; i < templates.size(); ++i) {
+			auto source_var = "source_" + std::to_string(i);
+			std::string body;
+			templates[i].write_cpp(body, source_var, 2);
+
+			out << "\n\t// " << resources[i].path << "\n";
+			out << "\tstatic constexpr auto " << source_var << " =";
+			write_literal(out, resources[i].contents);
+			out << ";\n\n";
+			// Templates which read no parameters never use `params`.
+			out << "\tstatic void render_" << i
+				<< "(TextSink & output, [[maybe_unused]] TextParams const& params) try {\n";
+			out << body;
+			out << "\t} catch (preprocess_text_error & error) {\n";
+			out << "\t\terror.input = " << source_var << ";\n";
+			out << "\t\tthrow;\n";
+			out << "\t}\n\n";
+
+			auto param_names = templates[i].param_names();
+			out << "\tstatic constexpr std::array<string_view, " << param_names.size()
+				<< "> param_names_" << i << "{";
+
+			for (auto name: param_names) {
+				auto pos = name.data() - templates[i].source().data();
+				out << "\n\t\t" << source_var << ".substr(" << pos << ", " << name.size() << "),";
+			}
+
+			out << "\n\t};\n";
+		}
+
+		out << "\n\tconst compiled_template compiled_templates[] = {\n";
+
+		for (std::size_t i = 0; i < templates.size(); ++i) {
+			out << "\t\t{\"" << resources[i].path << "\"sv, {render_" << i
+				<< ", param_names_" << i << "}},\n";
+		}
+
+		out << "\t};\n\n";
+		out << "\tconst std::size_t num_compiled_templates = " << templates.size() << ";\n";
+		out << "}\n";
+	}
+
+	template <typename T>
+	void write_bytes(std::ostream & out, const T & t) {
+		out.write(reinterpret_cast<const char *>(&t), sizeof(t));
+	}
+
+	void write_pack(std::ostream & out, const std::vector<resource> & resources) {
+		using namespace maf::_resources_impl;
+
+		pack_header header{};
+		std::copy(std::begin(pack_magic), std::end(pack_magic), header.magic);
+		header.version = pack_version;
+		header.num_entries = static_cast<std::uint32_t>(resources.size());
+
+		std::vector<pack_entry> entries;
+		std::size_t offset = sizeof(pack_header) + resources.size() * sizeof(pack_entry);
+
+		auto next_offset = [&](std::size_t size) {
+			if (offset + size > UINT32_MAX) {
+				throw std::runtime_error{"resources too large for a pack"};
+			}
+
+			auto result = static_cast<std::uint32_t>(offset);
+			offset += size;
+			return result;
+		};
+
+		for (auto & res: resources) {
+			pack_entry entry{};
+			entry.path_size = static_cast<std::uint32_t>(res.path.size());
+			entry.path_offset = next_offset(res.path.size());
+			entry.contents_size = static_cast<std::uint32_t>(res.contents.size());
+			entry.contents_offset = next_offset(res.contents.size());
+			entries.push_back(entry);
+		}
+
+		write_bytes(out, header);
+		for (auto & entry: entries) write_bytes(out, entry);
+
+		for (auto & res: resources) {
+			out << res.path << res.contents;
+		}
+	}
+}
+
+int main(int argc, char * argv[]) {
+	std::string mode = (argc == 4) ? argv[1] : "";
+
+	if (argc != 3 && mode != "--pack" && mode != "--templates") {
+		std::cerr << "usage: " << argv[0]
+			<< " [--pack | --templates] <resources-dir> <output-file>\n";
+		return 2;
+	}
+
+	fs::path root = argv[argc - 2];
+	fs::path output_path = argv[argc - 1];
+
+	std::vector<resource> resources;
+
+	try {
+		for (auto & entry: fs::recursive_directory_iterator{root / "txt"}) {
+			if (!entry.is_regular_file()) continue;
+			if (entry.path().extension() != ".txt") continue;
+
+			auto path = entry.path().lexically_relative(root).generic_string();
+			resources.push_back({path, read_all(entry.path())});
+		}
+	} catch (const std::exception & e) {
+		std::cerr << argv[0] << ": " << e.what() << "\n";
+		return 1;
+	}
+
+	std::sort(resources.begin(), resources.end(),
+		[](auto & a, auto & b) { return a.path < b.path; });
+
+	// Generate the output in memory first, so that nothing is written if
+	// something goes wrong.
+	std::ostringstream contents;
+
+	try {
+		if (mode == "--pack") {
+			write_pack(contents, resources);
+		} else if (mode == "--templates") {
+			write_templates(contents, resources);
+		} else {
+			write_source(contents, resources);
+		}
+	} catch (const std::exception & e) {
+		std::cerr << e.what() << "\n";
+		return 1;
+	}
+
+	std::ofstream out{output_path, std::ios::binary};
+	out << contents.str();
+
+	if (!out) {
+		std::cerr << argv[0] << ": cannot write " << output_path.string() << "\n";
+		return 1;
+	}
+}
@@ -341,6 +341,12 @@ namespace maf::util {
 		using std::begin, std::end;
 		std::shuffle(begin(range), end(range), random::default_generator);
 	}
+
+	// Randomise the order of elements in `range` using `generator`.
+	void shuffle(auto&& range, std::uniform_random_bit_generator auto & generator) {
+		using std::begin, std::end;
+		std::shuffle(begin(range), end(range), generator);
+	}
 }
 
 #endif
@@ -6,7 +6,9 @@
 #include <gsl/pointers>
 
 namespace maf {
+	using std::make_shared;
 	using std::make_unique;
+	using std::shared_ptr;
 	using std::unique_ptr;
 
 	using gsl::not_null;
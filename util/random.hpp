@@ -9,64 +9,105 @@
 
 namespace maf::util::random {
 	// A `std::default_random_engine` used by various algorithms.
-	// Automatically seeded when the program first starts.
-	inline auto default_generator = std::default_random_engine{std::random_device{}()};
+	// Each thread has its own generator, which is automatically seeded the
+	// first time that the thread uses it.
+	inline thread_local auto default_generator = std::default_random_engine{std::random_device{}()};
+
+	// Generate a single result from a uniform integer distribution with
+	// minimum value `a` and maximum value `b`, using `generator`.
+	template <std::integral Int = int>
+	auto uniform_int_trial(Int a, Int b, std::uniform_random_bit_generator auto & generator) -> Int {
+		auto dist = std::uniform_int_distribution{a, b};
+		return dist(generator);
+	}
 
 	// Generate a single result from a uniform integer distribution with
 	// minimum value `a` and maximum value `b`.
 	template <std::integral Int = int>
 	auto uniform_int_trial(Int a, Int b) -> Int {
-		auto dist = std::uniform_int_distribution{a, b};
-		return dist(default_generator);
+		return uniform_int_trial<Int>(a, b, default_generator);
+	}
+
+	// Generate a single result from a Bernoulli distribution with probability
+	// `p` of success, using `generator`.
+	inline bool bernoulli_trial(double p, std::uniform_random_bit_generator auto & generator) {
+		auto dist = std::bernoulli_distribution{p};
+		return dist(generator);
 	}
 
 	// Generate a single result from a Bernoulli distribution with probability
 	// `p` of success.
 	inline bool bernoulli_trial(double p) {
-		auto dist = std::bernoulli_distribution{p};
-		return dist(default_generator);
+		return bernoulli_trial(p, default_generator);
 	}
 
 	// Generate a single result from a discrete distribution with the
-	// provided `weights`.
+	// provided `weights`, using `generator`.
 	template <std::integral ResultType = int>
-	auto discrete_trial(auto&& weights) -> ResultType {
+	auto discrete_trial(auto&& weights, std::uniform_random_bit_generator auto & generator) -> ResultType {
 		auto b    = std::begin(weights);
 		auto e    = std::end(weights);
 		auto dist = std::discrete_distribution<ResultType>{b, e};
 
-		return dist(default_generator);
+		return dist(generator);
 	}
 
-	// Pick a random position in `range` using `random::default_generator`.
+	// Generate a single result from a discrete distribution with the
+	// provided `weights`.
+	template <std::integral ResultType = int>
+	auto discrete_trial(auto&& weights) -> ResultType {
+		return discrete_trial<ResultType>(weights, default_generator);
+	}
+
+	// Pick a random position in `range` using `generator`.
 	//
 	// If `range` is empty, returns `std::end(range)` instead.
-	auto pick(auto& range) -> decltype(std::begin(range)) {
+	auto pick(auto& range, std::uniform_random_bit_generator auto & generator)
+	-> decltype(std::begin(range)) {
 		if (std::empty(range)) return std::end(range);
 
 		auto i = std::begin(range);
-		auto n = uniform_int_trial<int>(0, std::size(range) - 1);
+		auto n = uniform_int_trial<int>(0, std::size(range) - 1, generator);
 		std::advance(i, n);
 
 		return i;
 	}
 
 	// Pick a random position in `range` using `random::default_generator`.
-	// The likelihood of each position being selected is determined by
-	// the corresponding weight in `weights`.
+	//
+	// If `range` is empty, returns `std::end(range)` instead.
+	auto pick(auto& range) -> decltype(std::begin(range)) {
+		return pick(range, default_generator);
+	}
+
+	// Pick a random position in `range` using `generator`. The likelihood
+	// of each position being selected is determined by the corresponding
+	// weight in `weights`.
 	//
 	// If `range` is empty, returns `std::end(range)` instead.
 	//
 	// Undefined behaviour if `range` and `weights` are not the same size.
-	auto pick(auto& range, auto&& weights) -> decltype(std::begin(range)) {
+	auto pick(auto& range, auto&& weights, std::uniform_random_bit_generator auto & generator)
+	-> decltype(std::begin(range)) {
 		if (std::empty(range)) return std::end(range);
 
 		auto i = std::begin(range);
-		auto n = discrete_trial(weights);
+		auto n = discrete_trial(weights, generator);
 		std::advance(i, n);
 
 		return i;
 	}
+
+	// Pick a random position in `range` using `random::default_generator`.
+	// The likelihood of each position being selected is determined by
+	// the corresponding weight in `weights`.
+	//
+	// If `range` is empty, returns `std::end(range)` instead.
+	//
+	// Undefined behaviour if `range` and `weights` are not the same size.
+	auto pick(auto& range, auto&& weights) -> decltype(std::begin(range)) {
+		return pick(range, weights, default_generator);
+	}
 }
 
 #endif
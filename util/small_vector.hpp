@@ -0,0 +1,86 @@
+#ifndef MAFIA_UTIL_SMALL_VECTOR_H
+#define MAFIA_UTIL_SMALL_VECTOR_H
+
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <type_traits>
+
+#include "vector.hpp"
+
+namespace maf::util {
+	// A sequence of values which are stored inside the object itself, until
+	// there are more than `N` of them. Only then is memory allocated, and
+	// every value moved onto the heap.
+	//
+	// Only trivially-copyable types are supported, such as `string_view`.
+	template <typename T, std::size_t N>
+	class small_vector {
+		static_assert(std::is_trivially_copyable_v<T>);
+
+	public:
+		using value_type = T;
+		using size_type = std::size_t;
+		using iterator = T *;
+		using const_iterator = const T *;
+
+		small_vector() = default;
+
+		small_vector(std::initializer_list<T> values) {
+			for (auto& x: values) push_back(x);
+		}
+
+		// Whether the values have been moved onto the heap. Once spilled, the
+		// values stay on the heap until the vector is destroyed.
+		bool is_spilled() const { return _spilled; }
+
+		std::size_t size() const { return _size; }
+		bool empty() const { return _size == 0; }
+
+		T * data() { return is_spilled() ? _heap.data() : _inline.data(); }
+		const T * data() const { return is_spilled() ? _heap.data() : _inline.data(); }
+
+		T & operator[](std::size_t i) { return data()[i]; }
+		const T & operator[](std::size_t i) const { return data()[i]; }
+
+		T & front() { return data()[0]; }
+		const T & front() const { return data()[0]; }
+		T & back() { return data()[_size - 1]; }
+		const T & back() const { return data()[_size - 1]; }
+
+		iterator begin() { return data(); }
+		iterator end() { return data() + _size; }
+		const_iterator begin() const { return data(); }
+		const_iterator end() const { return data() + _size; }
+
+		void push_back(const T & x) {
+			if (is_spilled()) {
+				_heap.push_back(x);
+			} else if (_size < N) {
+				_inline[_size] = x;
+			} else {
+				_heap.reserve(2 * N);
+				_heap.assign(_inline.begin(), _inline.end());
+				_heap.push_back(x);
+				_spilled = true;
+			}
+
+			++_size;
+		}
+
+		// Remove every value. Any memory on the heap is kept, and new values
+		// are stored in it rather than back inside the object.
+		void clear() {
+			_heap.clear();
+			_size = 0;
+		}
+
+	private:
+		std::array<T, N> _inline{};
+		vector<T> _heap{};
+		std::size_t _size{0};
+		bool _spilled{false};
+	};
+}
+
+#endif